@@ -0,0 +1,89 @@
+#include "attacks.h"
+
+namespace {
+
+// Ray directions as {row, col} steps. The first four increase the square
+// index (the nearest blocker is the lowest bit), the last four decrease it.
+const int RAY_STEPS[8][2] = {
+    {1, 0}, {0, 1}, {1, 1}, {1, -1},
+    {-1, 0}, {0, -1}, {-1, -1}, {-1, 1}
+};
+
+struct AttackTables {
+    uint64_t knight[64];
+    uint64_t king[64];
+    uint64_t pawn[2][64];
+    uint64_t rays[8][64];
+
+    AttackTables() {
+        static const int knightSteps[8][2] = {
+            {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}
+        };
+
+        for (int sq = 0; sq < 64; sq++) {
+            int row = sq / 8, col = sq % 8;
+            knight[sq] = king[sq] = pawn[0][sq] = pawn[1][sq] = 0;
+
+            for (const auto& step : knightSteps) {
+                knight[sq] |= bit(row + step[0], col + step[1]);
+            }
+            for (int dr = -1; dr <= 1; dr++) {
+                for (int dc = -1; dc <= 1; dc++) {
+                    if (dr || dc) king[sq] |= bit(row + dr, col + dc);
+                }
+            }
+            pawn[0][sq] = bit(row + 1, col - 1) | bit(row + 1, col + 1);
+            pawn[1][sq] = bit(row - 1, col - 1) | bit(row - 1, col + 1);
+
+            for (int d = 0; d < 8; d++) {
+                rays[d][sq] = 0;
+                for (int r = row + RAY_STEPS[d][0], c = col + RAY_STEPS[d][1];
+                     r >= 0 && r < 8 && c >= 0 && c < 8;
+                     r += RAY_STEPS[d][0], c += RAY_STEPS[d][1]) {
+                    rays[d][sq] |= 1ULL << (r * 8 + c);
+                }
+            }
+        }
+    }
+
+    static uint64_t bit(int row, int col) {
+        return (row >= 0 && row < 8 && col >= 0 && col < 8) ? 1ULL << (row * 8 + col) : 0;
+    }
+};
+
+const AttackTables tables;
+
+// Attacks along one ray, stopping at (and including) the first blocker
+uint64_t rayAttacks(int direction, int square, uint64_t occupied) {
+    uint64_t ray = tables.rays[direction][square];
+    uint64_t blockers = ray & occupied;
+    if (blockers) {
+        int blocker = direction < 4 ? Attacks::lsb(blockers) : Attacks::msb(blockers);
+        ray ^= tables.rays[direction][blocker];
+    }
+    return ray;
+}
+
+} // namespace
+
+uint64_t Attacks::knight(int square) {
+    return tables.knight[square];
+}
+
+uint64_t Attacks::king(int square) {
+    return tables.king[square];
+}
+
+uint64_t Attacks::pawn(int color, int square) {
+    return tables.pawn[color][square];
+}
+
+uint64_t Attacks::bishop(int square, uint64_t occupied) {
+    return rayAttacks(2, square, occupied) | rayAttacks(3, square, occupied) |
+           rayAttacks(6, square, occupied) | rayAttacks(7, square, occupied);
+}
+
+uint64_t Attacks::rook(int square, uint64_t occupied) {
+    return rayAttacks(0, square, occupied) | rayAttacks(1, square, occupied) |
+           rayAttacks(4, square, occupied) | rayAttacks(5, square, occupied);
+}
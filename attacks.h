@@ -0,0 +1,60 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "main.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Bitboard attack generation. Squares are numbered row * 8 + col (a1 = 0,
+// h8 = 63). Knight and king attacks come from precomputed tables; sliders
+// use precomputed rays cut off at the first blocker.
+class Attacks {
+public:
+    // Number of set bits
+    static int popCount(uint64_t b) {
+#ifdef _MSC_VER
+        return static_cast<int>(__popcnt64(b));
+#else
+        return __builtin_popcountll(b);
+#endif
+    }
+
+    // Index of the lowest and highest set bit (b must not be zero)
+    static int lsb(uint64_t b) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, b);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctzll(b);
+#endif
+    }
+
+    static int msb(uint64_t b) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, b);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(b);
+#endif
+    }
+
+    static uint64_t knight(int square);
+    static uint64_t king(int square);
+
+    // Squares attacked by a pawn of the given color (0 = white) on the square
+    static uint64_t pawn(int color, int square);
+
+    // Slider attacks given the occupied squares; blockers are included
+    static uint64_t bishop(int square, uint64_t occupied);
+    static uint64_t rook(int square, uint64_t occupied);
+    static uint64_t queen(int square, uint64_t occupied) { return bishop(square, occupied) | rook(square, occupied); }
+
+    // All squares of a file (0 = a-file)
+    static uint64_t fileMask(int file) { return 0x0101010101010101ULL << file; }
+};
+
+#endif // ATTACKS_H
@@ -1,4 +1,7 @@
 #include "board.h"
+#include "zobrist.h"
+#include "psqt.h"
+#include <sstream>
 
 Board::Board()
 {
@@ -14,6 +17,11 @@ Board::Board()
     enPassantTarget = Position();
     halfMoveClock = 0;
     fullMoveNumber = 1;
+    hashKey = 0;
+    mgScore = 0;
+    egScore = 0;
+    gamePhase = 0;
+    pawnKey = 0;
 
     // Initialize the kings as nullptr
     whiteKing = nullptr;
@@ -68,6 +76,8 @@ void Board::setupStartingPosition()
     enPassantTarget = Position();
     halfMoveClock = 0;
     fullMoveNumber = 1;
+
+    hashKey = Zobrist::generateHashKey(*this);
 }
 
 void Board::setupFromFEN(const std::string &fen)
@@ -164,6 +174,8 @@ void Board::setupFromFEN(const std::string &fen)
 
     // Parse fullmove number
     fullMoveNumber = std::stoi(fullmove);
+
+    hashKey = Zobrist::generateHashKey(*this);
 }
 
 std::string Board::toFEN() const
@@ -258,10 +270,39 @@ void Board::setPieceAt(const Position &pos, std::shared_ptr<Piece> piece)
 {
     if (!pos.isValid())
         return;
+
+    // Remove the old occupant from the evaluation terms and pawn key, then add the new one
+    auto oldPiece = squares[pos.row][pos.col];
+    if (oldPiece)
+    {
+        mgScore -= PSQT::mg(oldPiece->getType(), oldPiece->getColor(), pos);
+        egScore -= PSQT::eg(oldPiece->getType(), oldPiece->getColor(), pos);
+        gamePhase -= PSQT::phase(oldPiece->getType());
+        if (oldPiece->getType() == PieceType::PAWN)
+        {
+            pawnKey ^= Zobrist::pawnKey(oldPiece->getColor(), pos);
+        }
+        if (NNUE::isLoaded() && accumulator.get())
+        {
+            NNUE::updatePiece(*this, *accumulator.get(), *oldPiece, pos, -1);
+        }
+    }
+
     squares[pos.row][pos.col] = piece;
     if (piece)
     {
         piece->setPosition(pos);
+        mgScore += PSQT::mg(piece->getType(), piece->getColor(), pos);
+        egScore += PSQT::eg(piece->getType(), piece->getColor(), pos);
+        gamePhase += PSQT::phase(piece->getType());
+        if (piece->getType() == PieceType::PAWN)
+        {
+            pawnKey ^= Zobrist::pawnKey(piece->getColor(), pos);
+        }
+        if (NNUE::isLoaded() && accumulator.get())
+        {
+            NNUE::updatePiece(*this, *accumulator.get(), *piece, pos, 1);
+        }
     }
 }
 
@@ -275,9 +316,11 @@ bool Board::makeMove(const Move &move, BoardState &previousState)
     previousState.enPassantTarget = enPassantTarget;
     previousState.halfMoveClock = halfMoveClock;
     previousState.fullMoveNumber = fullMoveNumber;
+    previousState.hashKey = hashKey;
     previousState.capturedPiece = nullptr;
     previousState.wasEnPassant = false;
     previousState.wasPromotion = false;
+    previousState.promotedPawn = nullptr;
 
     // Get the piece at the source position
     auto piece = getPieceAt(move.from);
@@ -308,6 +351,9 @@ bool Board::makeMove(const Move &move, BoardState &previousState)
 
     previousState.pieceHasMoved = piece->getHasMoved();
 
+    // Compute the new hash key while the board still shows the old position
+    uint64_t newHashKey = Zobrist::updateHashKey(hashKey, move, *this);
+
       // Handle castling
     if (piece->getType() == PieceType::KING) {
         // Kingside castling
@@ -374,6 +420,7 @@ bool Board::makeMove(const Move &move, BoardState &previousState)
     // Handle pawn promotion
     if (isPawnMove && (move.to.row == 0 || move.to.row == 7) && move.promotion != PieceType::NONE) {
         previousState.wasPromotion = true;
+        previousState.promotedPawn = piece;
         
         switch (move.promotion) {
             case PieceType::QUEEN:
@@ -444,6 +491,8 @@ bool Board::makeMove(const Move &move, BoardState &previousState)
     // Switch side to move
     switchSideToMove();
     
+    hashKey = newHashKey;
+    
     return true;
 }
 
@@ -453,9 +502,11 @@ bool Board::unmakeMove(const Move& move, const BoardState& previousState) {
     auto piece = getPieceAt(move.to);
     if (!piece) return false;
     
-    // If this was a promotion, create the original piece type (pawn)
+    // If this was a promotion, put the original pawn back. Board copies share
+    // their pieces, so a new pawn would leave the old one with a stale position.
     if (previousState.wasPromotion) {
-        piece = std::make_shared<Pawn>(previousState.sideToMove, move.from);
+        piece = previousState.promotedPawn ? previousState.promotedPawn
+                                           : std::make_shared<Pawn>(previousState.sideToMove, move.from);
     }
     
     // Move the piece back to the source
@@ -508,10 +559,33 @@ bool Board::unmakeMove(const Move& move, const BoardState& previousState) {
     enPassantTarget = previousState.enPassantTarget;
     halfMoveClock = previousState.halfMoveClock;
     fullMoveNumber = previousState.fullMoveNumber;
+    hashKey = previousState.hashKey;
     
     return true;
 }
 
+void Board::makeNullMove(BoardState &previousState)
+{
+    previousState.sideToMove = sideToMove;
+    previousState.enPassantTarget = enPassantTarget;
+    previousState.halfMoveClock = halfMoveClock;
+    previousState.hashKey = hashKey;
+
+    hashKey = Zobrist::updateHashKeyNullMove(hashKey, *this);
+
+    enPassantTarget = Position();
+    halfMoveClock++;
+    switchSideToMove();
+}
+
+void Board::unmakeNullMove(const BoardState &previousState)
+{
+    sideToMove = previousState.sideToMove;
+    enPassantTarget = previousState.enPassantTarget;
+    halfMoveClock = previousState.halfMoveClock;
+    hashKey = previousState.hashKey;
+}
+
 std::vector<Move> Board::generateLegalMoves() const
 {
     std::vector<Move> legalMoves;
@@ -541,6 +615,46 @@ std::vector<Move> Board::generateLegalMoves() const
     return legalMoves;
 }
 
+std::vector<Move> Board::generateMoves(bool tactical) const
+{
+    std::vector<Move> moves;
+
+    for (int row = 0; row < 8; row++)
+    {
+        for (int col = 0; col < 8; col++)
+        {
+            auto piece = getPieceAt(Position(row, col));
+
+            if (piece && piece->getColor() == sideToMove)
+            {
+                // Only moves of the requested kind are generated, so the two
+                // kinds together cost one full generation
+                auto pieceMoves = piece->generateMoves(*this, tactical ? MoveFilter::TACTICAL : MoveFilter::QUIET);
+
+                for (const auto &move : pieceMoves)
+                {
+                    if (!wouldBeInCheck(move, sideToMove))
+                    {
+                        moves.push_back(move);
+                    }
+                }
+            }
+        }
+    }
+
+    return moves;
+}
+
+bool Board::isTactical(const Move &move) const
+{
+    auto piece = getPieceAt(move.from);
+    if (!piece)
+        return false;
+
+    return getPieceAt(move.to) != nullptr || move.promotion != PieceType::NONE ||
+           (piece->getType() == PieceType::PAWN && move.to == enPassantTarget);
+}
+
 bool Board::isInCheck() const
 {
     auto king = (sideToMove == Color::WHITE) ? whiteKing : blackKing;
@@ -645,6 +759,7 @@ void Board::clear()
     enPassantTarget = Position();
     halfMoveClock = 0;
     fullMoveNumber = 1;
+    hashKey = 0;
 }
 
 bool Board::canCastle(const Move &move) const
@@ -797,5 +912,26 @@ bool Board::wouldBeInCheck(const Move &move, Color kingColor) const
     }
 
     // Check if the king is in check after the move
-    return tempBoard.isSquareAttacked(kingPos, (kingColor == Color::WHITE) ? Color::BLACK : Color::WHITE);
+    bool inCheck = tempBoard.isSquareAttacked(kingPos, (kingColor == Color::WHITE) ? Color::BLACK : Color::WHITE);
+
+    // The temporary board shares its pieces with this one, so put back the
+    // positions that setPieceAt changed on them
+    piece->setPosition(move.from);
+    if (piece->getType() == PieceType::KING && move.from.col == 4)
+    {
+        if (move.to.col == 6)
+        {
+            auto rook = getPieceAt(Position(move.from.row, 7));
+            if (rook)
+                rook->setPosition(Position(move.from.row, 7));
+        }
+        else if (move.to.col == 2)
+        {
+            auto rook = getPieceAt(Position(move.from.row, 0));
+            if (rook)
+                rook->setPosition(Position(move.from.row, 0));
+        }
+    }
+
+    return inCheck;
 }
\ No newline at end of file
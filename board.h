@@ -5,6 +5,7 @@
 #include "piece.h"
 #include "piece_types.h"
 #include "board_state.h"
+#include "nnue.h"
 
 class Board {
 private:
@@ -17,6 +18,12 @@ private:
     Position enPassantTarget;
     int halfMoveClock; // for 50-move rule
     int fullMoveNumber;
+    uint64_t hashKey; // Zobrist key, updated incrementally by make/unmake
+    int mgScore;   // Midgame material + piece-square score (white - black)
+    int egScore;   // Endgame material + piece-square score (white - black)
+    int gamePhase; // Remaining non-pawn material, see PSQT::MAX_PHASE
+    uint64_t pawnKey; // Zobrist key of the pawns only, updated by setPieceAt
+    mutable NNUEAccumulatorPtr accumulator; // Network first layer, updated by setPieceAt
     std::shared_ptr<King> whiteKing;
     std::shared_ptr<King> blackKing;
 
@@ -35,19 +42,39 @@ public:
     // Get a piece at a specific position, or nullptr if empty
     std::shared_ptr<Piece> getPieceAt(const Position& pos) const;
     
-    // Set a piece at a specific position
+    // Set a piece at a specific position (keeps the evaluation terms up to date)
     void setPieceAt(const Position& pos, std::shared_ptr<Piece> piece);
     
-    // Add these method declarations to the Board class in board.h:
-bool makeMove(const Move& move) {
-    BoardState dummyState;
-    return makeMove(move, dummyState);
-}
-bool unmakeMove(const Move& move, const BoardState& previousState);
+    // Make a move, recording the state needed to unmake it
+    bool makeMove(const Move& move, BoardState& previousState);
+    
+    // Make a move without keeping undo information
+    bool makeMove(const Move& move) {
+        BoardState dummyState;
+        return makeMove(move, dummyState);
+    }
+    
+    // Unmake a move using the state recorded by makeMove
+    bool unmakeMove(const Move& move, const BoardState& previousState);
+    
+    // Pass the turn (null move): flips the side to move and clears en passant
+    void makeNullMove(BoardState& previousState);
+    
+    // Undo a null move made with makeNullMove
+    void unmakeNullMove(const BoardState& previousState);
     
     // Generate all legal moves for the current side to move
     std::vector<Move> generateLegalMoves() const;
     
+    // Generate the legal captures (including en passant) and promotions only
+    std::vector<Move> generateCaptureMoves() const { return generateMoves(true); }
+    
+    // Generate the legal moves that are neither captures nor promotions
+    std::vector<Move> generateQuietMoves() const { return generateMoves(false); }
+    
+    // Check if a move is a capture (en passant included) or a promotion
+    bool isTactical(const Move& move) const;
+    
     // Check if the current side to move is in check
     bool isInCheck() const;
     
@@ -74,7 +101,31 @@ bool unmakeMove(const Move& move, const BoardState& previousState);
     
     // En passant target accessor
     Position getEnPassantTarget() const { return enPassantTarget; }
-    
+
+    // Half-move clock accessor (plies since the last capture or pawn move)
+    int getHalfMoveClock() const { return halfMoveClock; }
+
+    // Zobrist hash key of the current position
+    uint64_t getHashKey() const { return hashKey; }
+
+    // Zobrist key of the pawn structure
+    uint64_t getPawnKey() const { return pawnKey; }
+
+    // Position of the king of the given color (invalid if there is none)
+    Position getKingPosition(Color color) const
+    {
+        auto king = (color == Color::WHITE) ? whiteKing : blackKing;
+        return king ? king->getPosition() : Position();
+    }
+
+    // Incrementally updated tapered evaluation terms (white's point of view)
+    int getMgScore() const { return mgScore; }
+    int getEgScore() const { return egScore; }
+    int getGamePhase() const { return gamePhase; }
+
+    // Neural network evaluation from the side to move's point of view (needs a loaded network)
+    int evaluateNNUE() const { return NNUE::evaluate(*this, accumulator.getOrCreate()); }
+
     // Print the board to the console
     void print() const;
     
@@ -85,6 +136,9 @@ private:
     // Check if a castling move is legal
     bool canCastle(const Move& move) const;
     
+    // Generate the legal tactical (captures and promotions) or quiet moves
+    std::vector<Move> generateMoves(bool tactical) const;
+    
     // Helper to verify king safety after move
     bool wouldBeInCheck(const Move& move, Color kingColor) const;
 };
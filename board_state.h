@@ -17,8 +17,10 @@ struct BoardState {
     std::shared_ptr<Piece> capturedPiece;
     bool wasEnPassant;
     bool wasPromotion;
+    std::shared_ptr<Piece> promotedPawn; // Pawn replaced by the promoted piece
     PieceType originalType;
     bool pieceHasMoved;
+    uint64_t hashKey;
     
     BoardState() : 
         sideToMove(Color::WHITE), 
@@ -32,8 +34,10 @@ struct BoardState {
         capturedPiece(nullptr),
         wasEnPassant(false),
         wasPromotion(false),
+        promotedPawn(nullptr),
         originalType(PieceType::NONE),
-        pieceHasMoved(false) {}
+        pieceHasMoved(false),
+        hashKey(0) {}
 };
 
 #endif // BOARD_STATE_H
\ No newline at end of file
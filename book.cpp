@@ -0,0 +1,148 @@
+#include "book.h"
+#include "board.h"
+#include "zobrist.h"
+
+OpeningBook::OpeningBook() : numEntries(0), rng(std::random_device{}()) {}
+
+bool OpeningBook::open(const std::string& filename) {
+    close();
+    
+    if (!file.open(filename)) {
+        return false;
+    }
+    
+    // A valid book is a whole number of entries
+    if (file.getSize() % ENTRY_SIZE != 0) {
+        file.close();
+        return false;
+    }
+    
+    path = filename;
+    numEntries = file.getSize() / ENTRY_SIZE;
+    return true;
+}
+
+void OpeningBook::close() {
+    file.close();
+    path.clear();
+    numEntries = 0;
+}
+
+OpeningBook::BookEntry OpeningBook::readEntry(size_t index) const {
+    const uint8_t* p = file.getData() + index * ENTRY_SIZE;
+    
+    BookEntry entry;
+    entry.key = 0;
+    for (int i = 0; i < 8; i++) {
+        entry.key = (entry.key << 8) | p[i];
+    }
+    entry.move = static_cast<uint16_t>((p[8] << 8) | p[9]);
+    entry.weight = static_cast<uint16_t>((p[10] << 8) | p[11]);
+    
+    return entry;
+}
+
+size_t OpeningBook::findFirst(uint64_t key) const {
+    // Binary search for the lower bound of the key
+    size_t low = 0;
+    size_t high = numEntries;
+    
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (readEntry(mid).key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+Move OpeningBook::decodeMove(uint16_t bookMove, const Board& board) const {
+    int toCol = bookMove & 7;
+    int toRow = (bookMove >> 3) & 7;
+    int fromCol = (bookMove >> 6) & 7;
+    int fromRow = (bookMove >> 9) & 7;
+    int promotion = (bookMove >> 12) & 7;
+    
+    Position from(fromRow, fromCol);
+    Position to(toRow, toCol);
+    
+    PieceType promotionType = PieceType::NONE;
+    switch (promotion) {
+        case 1: promotionType = PieceType::KNIGHT; break;
+        case 2: promotionType = PieceType::BISHOP; break;
+        case 3: promotionType = PieceType::ROOK; break;
+        case 4: promotionType = PieceType::QUEEN; break;
+        default: break;
+    }
+    
+    // Polyglot encodes castling as the king capturing its own rook
+    auto piece = board.getPieceAt(from);
+    if (piece && piece->getType() == PieceType::KING && fromCol == 4 && fromRow == toRow) {
+        if (toCol == 7) {
+            to = Position(toRow, 6);
+        } else if (toCol == 0) {
+            to = Position(toRow, 2);
+        }
+    }
+    
+    return Move(from, to, promotionType);
+}
+
+bool OpeningBook::probe(const Board& board, Move& bookMove) {
+    if (!isOpen()) return false;
+    
+    uint64_t key = Zobrist::generatePolyglotKey(board);
+    size_t first = findFirst(key);
+    
+    // Collect all legal moves stored for this position
+    std::vector<Move> legalMoves = board.generateLegalMoves();
+    std::vector<std::pair<Move, int>> candidates;
+    int totalWeight = 0;
+    
+    for (size_t i = first; i < numEntries; i++) {
+        BookEntry entry = readEntry(i);
+        if (entry.key != key) break;
+        
+        Move move = decodeMove(entry.move, board);
+        
+        // Guard against hash collisions and corrupt entries
+        bool isLegal = false;
+        for (const auto& legal : legalMoves) {
+            if (legal.from == move.from && legal.to == move.to && legal.promotion == move.promotion) {
+                isLegal = true;
+                break;
+            }
+        }
+        
+        if (isLegal) {
+            candidates.push_back(std::make_pair(move, static_cast<int>(entry.weight)));
+            totalWeight += entry.weight;
+        }
+    }
+    
+    if (candidates.empty()) return false;
+    
+    // All weights zero - treat the moves as equally good
+    if (totalWeight == 0) {
+        std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
+        bookMove = candidates[dist(rng)].first;
+        return true;
+    }
+    
+    // Weighted random selection
+    std::uniform_int_distribution<int> dist(0, totalWeight - 1);
+    int pick = dist(rng);
+    for (const auto& candidate : candidates) {
+        pick -= candidate.second;
+        if (pick < 0) {
+            bookMove = candidate.first;
+            return true;
+        }
+    }
+    
+    bookMove = candidates.back().first;
+    return true;
+}
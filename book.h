@@ -0,0 +1,61 @@
+#ifndef BOOK_H
+#define BOOK_H
+
+#include "main.h"
+#include "piece.h"
+#include "mapped_file.h"
+#include <random>
+
+// Polyglot (.bin) opening book.
+// The book is a sorted array of 16-byte big-endian entries:
+// key (8 bytes), move (2), weight (2), learn (4).
+class OpeningBook {
+private:
+    MappedFile file;
+    std::string path;
+    size_t numEntries;
+    std::mt19937 rng;
+    
+    // Size of one book entry in bytes
+    static const size_t ENTRY_SIZE = 16;
+    
+    // Decoded book entry
+    struct BookEntry {
+        uint64_t key;
+        uint16_t move;
+        uint16_t weight;
+    };
+    
+    // Read the entry at the given index
+    BookEntry readEntry(size_t index) const;
+    
+    // Find the first entry with the given key (or numEntries if none)
+    size_t findFirst(uint64_t key) const;
+    
+    // Convert a Polyglot move to our move format
+    Move decodeMove(uint16_t bookMove, const Board& board) const;
+    
+public:
+    OpeningBook();
+    
+    // Open a Polyglot book file
+    bool open(const std::string& filename);
+    
+    // Close the book
+    void close();
+    
+    // Check if a book is loaded
+    bool isOpen() const { return file.isOpen(); }
+    
+    // Get the path of the loaded book
+    const std::string& getPath() const { return path; }
+    
+    // Get the number of entries in the book
+    size_t getNumEntries() const { return numEntries; }
+    
+    // Pick a legal book move for the position, weighted by the entry weights.
+    // Returns false if the position is not in the book.
+    bool probe(const Board& board, Move& bookMove);
+};
+
+#endif // BOOK_H
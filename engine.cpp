@@ -1,87 +1,11 @@
 #include "engine.h"
+#include "attacks.h"
 #include <chrono>
 #include <limits>
 #include <algorithm>
 #include <sstream>
-
-// Initialize piece-square tables
-// These tables provide positional bonuses for pieces on specific squares
-const int Engine::pawnTable[64] = {
-    0,  0,  0,  0,  0,  0,  0,  0,
-    50, 50, 50, 50, 50, 50, 50, 50,
-    10, 10, 20, 30, 30, 20, 10, 10,
-    5,  5, 10, 25, 25, 10,  5,  5,
-    0,  0,  0, 20, 20,  0,  0,  0,
-    5, -5,-10,  0,  0,-10, -5,  5,
-    5, 10, 10,-20,-20, 10, 10,  5,
-    0,  0,  0,  0,  0,  0,  0,  0
-};
-
-const int Engine::knightTable[64] = {
-    -50,-40,-30,-30,-30,-30,-40,-50,
-    -40,-20,  0,  0,  0,  0,-20,-40,
-    -30,  0, 10, 15, 15, 10,  0,-30,
-    -30,  5, 15, 20, 20, 15,  5,-30,
-    -30,  0, 15, 20, 20, 15,  0,-30,
-    -30,  5, 10, 15, 15, 10,  5,-30,
-    -40,-20,  0,  5,  5,  0,-20,-40,
-    -50,-40,-30,-30,-30,-30,-40,-50
-};
-
-const int Engine::bishopTable[64] = {
-    -20,-10,-10,-10,-10,-10,-10,-20,
-    -10,  0,  0,  0,  0,  0,  0,-10,
-    -10,  0, 10, 10, 10, 10,  0,-10,
-    -10,  5,  5, 10, 10,  5,  5,-10,
-    -10,  0,  5, 10, 10,  5,  0,-10,
-    -10,  5,  5,  5,  5,  5,  5,-10,
-    -10,  0,  5,  0,  0,  5,  0,-10,
-    -20,-10,-10,-10,-10,-10,-10,-20
-};
-
-const int Engine::rookTable[64] = {
-    0,  0,  0,  0,  0,  0,  0,  0,
-    5, 10, 10, 10, 10, 10, 10,  5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    -5,  0,  0,  0,  0,  0,  0, -5,
-    0,  0,  0,  5,  5,  0,  0,  0
-};
-
-const int Engine::queenTable[64] = {
-    -20,-10,-10, -5, -5,-10,-10,-20,
-    -10,  0,  0,  0,  0,  0,  0,-10,
-    -10,  0,  5,  5,  5,  5,  0,-10,
-    -5,  0,  5,  5,  5,  5,  0, -5,
-    0,  0,  5,  5,  5,  5,  0, -5,
-    -10,  5,  5,  5,  5,  5,  0,-10,
-    -10,  0,  5,  0,  0,  0,  0,-10,
-    -20,-10,-10, -5, -5,-10,-10,-20
-};
-
-const int Engine::kingMiddleGameTable[64] = {
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -30,-40,-40,-50,-50,-40,-40,-30,
-    -20,-30,-30,-40,-40,-30,-30,-20,
-    -10,-20,-20,-20,-20,-20,-20,-10,
-    20, 20,  0,  0,  0,  0, 20, 20,
-    20, 30, 10,  0,  0, 10, 30, 20
-};
-
-const int Engine::kingEndGameTable[64] = {
-    -50,-40,-30,-20,-20,-30,-40,-50,
-    -30,-20,-10,  0,  0,-10,-20,-30,
-    -30,-10, 20, 30, 30, 20,-10,-30,
-    -30,-10, 30, 40, 40, 30,-10,-30,
-    -30,-10, 30, 40, 40, 30,-10,-30,
-    -30,-10, 20, 30, 30, 20,-10,-30,
-    -30,-30,  0,  0,  0,  0,-30,-30,
-    -50,-30,-30,-30,-30,-30,-30,-50
-};
+#include <fstream>
+#include <optional>
 
 // Get the best move for the current position
 Move Engine::getBestMove() {
@@ -92,177 +16,548 @@ Move Engine::getBestMove() {
     // Get a copy of the board
     Board board = game.getBoard();
     
+    // Play instantly from the opening book when the position is known
+    Move bookMove;
+    if (openingBook.probe(board, bookMove)) {
+        std::cout << "Book move: " << bookMove.toString() << std::endl;
+        principalVariation.clear();
+        multiPVLines.clear();
+        stats.bookMove = true;
+        writeStatsFile();
+        return bookMove;
+    }
+    
     // Increment transposition table age
     transpositionTable.incrementAge();
     
-    // Initialize Zobrist hashing
-    Zobrist::initialize();
-    uint64_t hashKey = Zobrist::generateHashKey(board);
+    // Decay the move ordering statistics of the previous searches
+    ageHistoryTables();
+    
+    // Repetitions are detected against the game history as well as the search path
+    positionKeys = game.getKeyHistory();
+    nullMoveKeyIndex = 0;
     
     // Use iterative deepening to find the best move
-    return iterativeDeepeningSearch(board, maxDepth, hashKey);
+    Move bestMove = iterativeDeepeningSearch(board, maxDepth);
+    
+    writeStatsFile();
+    
+    return bestMove;
+}
+
+// Append the counters of the last search to the stats file, one JSON object per line
+void Engine::writeStatsFile() const {
+    if (!statsFile.empty()) {
+        std::ofstream out(statsFile, std::ios::app);
+        if (out) {
+            out << stats.toJSON() << std::endl;
+        }
+    }
+}
+
+// Fixed positions searched by the bench command: the start position, Kiwipete
+// and a few standard test positions covering middlegames and endgames
+static const char* const benchPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+};
+
+void Engine::runBench(int depth) {
+    // Search every position to a fixed depth without time limits
+    bool savedTimeManaged = timeManaged;
+    int savedMultiPV = multiPV;
+    timeManaged = false;
+    multiPV = 1;
+    
+    clearTT();
+    pawnHashTable.clear();
+    evalCache.clear();
+    clearKillerMoves();
+    clearHistoryTable();
+    clearCounterMoves();
+    
+    const int numPositions = sizeof(benchPositions) / sizeof(benchPositions[0]);
+    SearchStats total;
+    auto benchStart = std::chrono::high_resolution_clock::now();
+    
+    for (int i = 0; i < numPositions; i++) {
+        std::cout << "Position " << (i + 1) << "/" << numPositions << ": " << benchPositions[i] << std::endl;
+        
+        Board board;
+        board.setupFromFEN(benchPositions[i]);
+        positionKeys.assign(1, board.getHashKey());
+        nullMoveKeyIndex = 0;
+        
+        resetStats();
+        searchStartTime = std::chrono::high_resolution_clock::now();
+        iterativeDeepeningSearch(board, depth);
+        total.merge(stats);
+    }
+    
+    auto benchEnd = std::chrono::high_resolution_clock::now();
+    long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(benchEnd - benchStart).count();
+    elapsed = std::max(1L, elapsed);
+    
+    std::cout << "===========================" << std::endl;
+    std::cout << "Total time (ms) : " << elapsed << std::endl;
+    std::cout << "Nodes searched  : " << total.nodes << std::endl;
+    std::cout << "Nodes/second    : " << total.nodes * 1000 / elapsed << std::endl;
+    std::cout << "RFP cutoffs     : " << total.reverseFutilityCuts << std::endl;
+    std::cout << "Futility prunes : " << total.futilityPrunes << std::endl;
+    std::cout << "LMP prunes      : " << total.lateMovePrunes << std::endl;
+    std::cout << "TT hits         : " << (total.ttProbes > 0 ? total.ttHits * 100 / total.ttProbes : 0) << "%" << std::endl;
+    std::cout << "First move cuts : " << static_cast<long>(total.firstMoveCutoffRate() * 100) << "%" << std::endl;
+    long evalProbes = total.evalCacheHits + total.evalCacheMisses;
+    if (evalProbes > 0) {
+        std::cout << "Eval cache hits : " << total.evalCacheHits * 100 / evalProbes << "%" << std::endl;
+    }
+    if (total.pawnHashProbes > 0) {
+        std::cout << "Pawn hash hits  : " << total.pawnHashHits * 100 / total.pawnHashProbes << "%" << std::endl;
+    }
+    
+    timeManaged = savedTimeManaged;
+    multiPV = savedMultiPV;
 }
 
-Move Engine::iterativeDeepeningSearch(Board& board, int maxDepth, uint64_t hashKey) {
+// Search the root with an aspiration window around the previous score
+int Engine::aspirationSearch(Board& board, int depth, int previousScore, std::vector<Move>& pv) {
+    // For depth 1, use full window
+    if (depth == 1) {
+        return negamax<SearchNodeType::ROOT>(board, depth, -MATE_SCORE, MATE_SCORE, pv, 0, Move(Position(), Position()));
+    }
+    
+    // Use aspiration windows for deeper searches
+    int delta = 50;
+    int alpha = previousScore - delta;
+    int beta = previousScore + delta;
+    int score;
+    
+    // Try with narrow window first
+    while (true) {
+        score = negamax<SearchNodeType::ROOT>(board, depth, alpha, beta, pv, 0, Move(Position(), Position()));
+    
+        // If the score falls within our window, we're good
+        if (score > alpha && score < beta) {
+            break;
+        }
+    
+        // A fail low or high against a bound that can't be widened any more
+        // is the exact score (being mated at the root scores -MATE_SCORE)
+        if ((score <= alpha && alpha <= -MATE_SCORE) || (score >= beta && beta >= MATE_SCORE)) {
+            break;
+        }
+    
+        // If we failed low (score <= alpha), widen the window
+        if (score <= alpha) {
+            alpha = std::max(-MATE_SCORE, alpha - delta);
+            delta *= 2; // Increase window size
+            std::cout << "Aspiration fail low. New alpha: " << alpha << std::endl;
+        } 
+        // If we failed high (score >= beta), widen the window
+        else if (score >= beta) {
+            beta = std::min(MATE_SCORE, beta + delta);
+            delta *= 2; // Increase window size
+            std::cout << "Aspiration fail high. New beta: " << beta << std::endl;
+        }
+        stats.aspirationResearches++;
+    }
+    
+    return score;
+}
+
+Move Engine::iterativeDeepeningSearch(Board& board, int maxDepth) {
     principalVariation.clear();
-    Move bestMove(Position(), Position());
+    Move bestMove;
+    Move previousBestMove;
     int bestScore = 0;
+    int previousScore = 0;
+
+    // For time management
+    long nodesPrevious = 0;
+
+    // For instability detection
+    int bestMoveChanges = 0;
+    int scoreSwings = 0;
+    bool isUnstable = false;
+
+    // Lines searched per iteration: the best move, then the best move with the
+    // first moves of the earlier lines excluded, and so on. The lines share the
+    // transposition table, so each one after the first is cheap to search.
+    int numLines = 1;
+    if (multiPV > 1) {
+        int numRootMoves = static_cast<int>(board.generateLegalMoves().size());
+        numLines = std::max(1, std::min(multiPV, numRootMoves));
+    }
+    multiPVLines.clear();
     
-     // Iterative deepening loop
+    // Iterative deepening loop
     for (int depth = 1; depth <= maxDepth; depth++) {
-        std::vector<Move> pv;
-        
         // Record nodes before this iteration
-        nodesPrevious = nodesSearched;
-        
+        nodesPrevious = stats.nodes;
+    
         // Store previous iteration's results
         previousBestMove = bestMove;
         previousScore = bestScore;
-        
-        // Get previous iteration's PV if available
-        std::vector<Move> previousPV;
-        if (depth > 1) {
-            previousPV = pvTable[depth - 1];
+    
+        std::vector<PVLine> lines;
+        excludedRootMoves.clear();
+        for (int pvIndex = 0; pvIndex < numLines; pvIndex++) {
+            long nodesBefore = stats.nodes;
+            int lineScore = pvIndex < static_cast<int>(multiPVLines.size()) ? multiPVLines[pvIndex].score : bestScore;
+            
+            std::vector<Move> pv;
+            int score = aspirationSearch(board, depth, lineScore, pv);
+            if (pv.empty()) {
+                break;
+            }
+            lines.push_back({score, stats.nodes - nodesBefore, pv});
+            excludedRootMoves.push_back(pv[0]);
         }
+        excludedRootMoves.clear();
+    
+        // Store the best move and score if we got valid results
+        if (!lines.empty()) {
+            multiPVLines = lines;
+            bestMove = lines[0].moves[0];
+            bestScore = lines[0].score;
+            principalVariation = lines[0].moves;
+        }
+    
+        // Instability detection
+        if (depth >= 2) {
+            // Check if best move changed
+            if (bestMove.from.row != previousBestMove.from.row || 
+                bestMove.from.col != previousBestMove.from.col || 
+                bestMove.to.row != previousBestMove.to.row || 
+                bestMove.to.col != previousBestMove.to.col) {
+                bestMoveChanges++;
+                std::cout << "Best move changed from " << previousBestMove.toString() 
+                          << " to " << bestMove.toString() << std::endl;
+            }
         
-        // Color is set to true for maximizing player (WHITE), false for minimizing player (BLACK)
-        bool maximizingPlayer = board.getSideToMove() == Color::WHITE;
+            // Check for significant evaluation swings
+            const int SCORE_SWING_THRESHOLD = 50; // Centipawns
+            if (std::abs(bestScore - previousScore) > SCORE_SWING_THRESHOLD) {
+                scoreSwings++;
+                std::cout << "Score swing detected: " << previousScore 
+                          << " -> " << bestScore << std::endl;
+            }
         
-       // Search with appropriate window
-        int score = pvSearch(board, depth, alpha, beta, maximizingPlayer, pv, hashKey, 0, Move(Position(), Position()));
+            // Determine if position is unstable
+            isUnstable = (bestMoveChanges >= 2 || scoreSwings >= 1) && depth >= 3;
         
-        // Store the best move and score if we got valid results
-        if (!pv.empty()) {
-            bestMove = pv[0];
-            bestScore = score;
-            principalVariation = pv;
-            
-            // Store this iteration's PV for future use
-            storePV(depth, pv);
-            
-            std::cout << "PV at depth " << depth << ": " << getPVString(pv) << std::endl;
+            if (isUnstable && !positionIsUnstable) {
+                std::cout << "Position detected as unstable. Allocating more time." << std::endl;
+                positionIsUnstable = true;
+            }
         }
-        
+    
         // Log the progress
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - searchStartTime);
+    
+        // Nodes for this iteration
+        long nodesThisIteration = stats.nodes - nodesPrevious;
+        stats.depth = depth;
+        stats.timeMs = duration.count();
+    
+        for (size_t i = 0; i < multiPVLines.size(); i++) {
+            std::cout << "Depth: " << depth;
+            if (numLines > 1) {
+                std::cout << ", MultiPV: " << (i + 1);
+            }
+            std::cout << ", SelDepth: " << stats.selDepth
+                      << ", Score: " << formatScore(multiPVLines[i].score)
+                      << ", Nodes: " << (numLines > 1 ? multiPVLines[i].nodes : stats.nodes)
+                      << ", Time: " << duration.count() << "ms" 
+                      << ", NPS: " << stats.nodesPerSecond()
+                      << ", PV: " << formatPV(multiPVLines[i].moves) << std::endl;
+        }
+    
+        // Time management check
+        if (timeManaged && timeAllocated > 0) {
+            // Check if we should start next iteration
+            int timeUsed = duration.count();
+        
+            // Calculate adjusted time allocation based on position stability
+            int adjustedTimeAllocation = timeAllocated;
+            if (positionIsUnstable) {
+                adjustedTimeAllocation += (timeAllocated * unstableExtensionPercent) / 100;
+                std::cout << "Extending time allocation to " << adjustedTimeAllocation 
+                          << "ms due to position instability" << std::endl;
+            }
+        
+            // Estimate time for next iteration: typically 4-5x more nodes required
+            long estimatedNodesNext = nodesThisIteration * 4.5;
+            double estimatedTimeNext = (double)timeUsed * estimatedNodesNext / std::max(1L, nodesThisIteration);
         
-        std::cout << "Depth: " << depth 
-                  << ", Score: " << score 
-                  << ", Nodes: " << nodesSearched 
-                  << ", Time: " << duration.count() << "ms" 
-                  << ", NPS: " << static_cast<long>(nodesSearched * 1000.0 / duration.count())
-                  << std::endl;
+            // If we estimate we'll exceed our adjusted time allocation for the next iteration, stop now
+            if (timeUsed + estimatedTimeNext + timeBuffer > adjustedTimeAllocation) {
+                std::cout << "Stopping search due to time constraints. Time used: " 
+                          << timeUsed << "ms, Estimated for next: " 
+                          << estimatedTimeNext << "ms" << std::endl;
+                break;
+            }
+        }
     }
-    
+
     return bestMove;
 }
 
 // Get the principal variation as a string
 std::string Engine::getPVString() const {
+    return formatPV(principalVariation);
+}
+
+// Format the moves of a line for output
+std::string Engine::formatPV(const std::vector<Move>& pv) {
     std::stringstream ss;
     
-    for (size_t i = 0; i < principalVariation.size(); i++) {
-        ss << principalVariation[i].toString() << " ";
+    for (size_t i = 0; i < pv.size(); i++) {
+        ss << pv[i].toString() << " ";
     }
     
     return ss.str();
 }
 
-// Static Exchange Evaluation (SEE)
-int Engine::seeCapture(const Board& board, const Move& move) const {
-    auto capturedPiece = board.getPieceAt(move.to);
-    if (!capturedPiece) return 0; // Not a capture
-    
-    auto movingPiece = board.getPieceAt(move.from);
-    if (!movingPiece) return 0; // Should never happen
-    
-    // Get the value of the captured piece
-    int captureValue = getPieceValue(capturedPiece->getType());
+// Piece layout used by the exchange evaluation. Pieces are removed as they
+// join the exchange, which uncovers sliders behind them (x-rays).
+struct SeeBoard {
+    PieceType types[64];
+    Color colors[64];
+    
+    explicit SeeBoard(const Board& board) {
+        for (int sq = 0; sq < 64; sq++) {
+            auto piece = board.getPieceAt(Position(sq / 8, sq % 8));
+            types[sq] = piece ? piece->getType() : PieceType::NONE;
+            colors[sq] = piece ? piece->getColor() : Color::NONE;
+        }
+    }
     
-    // Make the capture and see what happens
-    return captureValue - see(board, move.to, movingPiece->getColor(), getPieceValue(movingPiece->getType()));
-}
-
-// Recursive SEE function
-int Engine::see(const Board& board, const Position& square, Color side, int captureValue) const {
-    // Find the least valuable attacker of the opposite color
-    auto leastValuableAttacker = Position();
-    int leastValuableAttackerValue = 100000;
-    PieceType leastValuableAttackerType = PieceType::NONE;
+    bool isPiece(int row, int col, Color side, PieceType type) const {
+        if (row < 0 || row > 7 || col < 0 || col > 7) return false;
+        int sq = row * 8 + col;
+        return types[sq] == type && colors[sq] == side;
+    }
     
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 8; col++) {
-            Position pos(row, col);
-            auto piece = board.getPieceAt(pos);
+    // Square of the least valuable piece of the given side attacking the target, or -1
+    int leastValuableAttacker(int target, Color side) const {
+        int row = target / 8, col = target % 8;
+        int best = -1;
+        PieceType bestType = PieceType::NONE;
+        
+        auto consider = [&](int r, int c) {
+            PieceType type = types[r * 8 + c];
+            if (best < 0 || static_cast<int>(type) < static_cast<int>(bestType)) {
+                best = r * 8 + c;
+                bestType = type;
+            }
+        };
+        
+        // Pawns attack diagonally forward
+        int pawnRow = (side == Color::WHITE) ? row - 1 : row + 1;
+        for (int dc : {-1, 1}) {
+            if (isPiece(pawnRow, col + dc, side, PieceType::PAWN)) return pawnRow * 8 + col + dc;
+        }
+        
+        static const int knightOffsets[8][2] = {
+            {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}
+        };
+        for (const auto& offset : knightOffsets) {
+            if (isPiece(row + offset[0], col + offset[1], side, PieceType::KNIGHT)) {
+                return (row + offset[0]) * 8 + col + offset[1];
+            }
+        }
+        
+        // Sliders: the first piece along each ray, looking through removed pieces
+        static const int directions[8][2] = {
+            {1, 1}, {1, -1}, {-1, 1}, {-1, -1}, {1, 0}, {-1, 0}, {0, 1}, {0, -1}
+        };
+        for (int d = 0; d < 8; d++) {
+            bool diagonal = d < 4;
+            int r = row + directions[d][0], c = col + directions[d][1];
+            while (r >= 0 && r < 8 && c >= 0 && c < 8 && types[r * 8 + c] == PieceType::NONE) {
+                r += directions[d][0];
+                c += directions[d][1];
+            }
+            if (r < 0 || r > 7 || c < 0 || c > 7 || colors[r * 8 + c] != side) continue;
             
-            if (piece && piece->getColor() != side) {
-                // Check if this piece can capture the target
-                auto moves = piece->getLegalMoves(board);
-                
-                for (const auto& move : moves) {
-                    if (move.to == square) {
-                        int pieceValue = getPieceValue(piece->getType());
-                        
-                        if (pieceValue < leastValuableAttackerValue) {
-                            leastValuableAttackerValue = pieceValue;
-                            leastValuableAttacker = pos;
-                            leastValuableAttackerType = piece->getType();
-                        }
-                        
-                        break;
-                    }
+            PieceType type = types[r * 8 + c];
+            if (type == PieceType::QUEEN || type == (diagonal ? PieceType::BISHOP : PieceType::ROOK)) {
+                consider(r, c);
+            }
+        }
+        if (best >= 0) return best;
+        
+        for (int dr = -1; dr <= 1; dr++) {
+            for (int dc = -1; dc <= 1; dc++) {
+                if ((dr || dc) && isPiece(row + dr, col + dc, side, PieceType::KING)) {
+                    return (row + dr) * 8 + col + dc;
                 }
             }
         }
+        return -1;
     }
+};
+
+// Static Exchange Evaluation (SEE) with a swap list: the material balance of the
+// capture sequence on the destination square, each side recapturing with its
+// least valuable attacker and stopping when continuing would lose material
+int Engine::seeCapture(const Board& board, const Move& move) const {
+    auto movingPiece = board.getPieceAt(move.from);
+    if (!movingPiece) return 0;
     
-    // If no attacker found, the previous capture was the end of the sequence
-    if (leastValuableAttackerType == PieceType::NONE) {
-        return 0;
+    auto capturedPiece = board.getPieceAt(move.to);
+    bool enPassant = !capturedPiece && movingPiece->getType() == PieceType::PAWN &&
+                     move.to == board.getEnPassantTarget();
+    if (!capturedPiece && !enPassant && move.promotion == PieceType::NONE) return 0; // Not a capture
+    
+    SeeBoard see(board);
+    int target = move.to.row * 8 + move.to.col;
+    int gain[32];
+    int d = 0;
+    
+    // The first capture, including the material gained by a promotion
+    gain[0] = capturedPiece ? getPieceValue(capturedPiece->getType()) : enPassant ? PAWN_VALUE : 0;
+    PieceType onSquare = movingPiece->getType();
+    if (move.promotion != PieceType::NONE) {
+        gain[0] += getPieceValue(move.promotion) - PAWN_VALUE;
+        onSquare = move.promotion;
     }
     
-    // Recursive SEE if there are more captures
-    int score = captureValue - see(board, square, (side == Color::WHITE) ? Color::BLACK : Color::WHITE, leastValuableAttackerValue);
+    see.types[move.from.row * 8 + move.from.col] = PieceType::NONE;
+    if (enPassant) {
+        see.types[move.from.row * 8 + move.to.col] = PieceType::NONE;
+    }
+    
+    Color side = (movingPiece->getColor() == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    Color other = movingPiece->getColor();
     
-    return std::max(0, score); // Don't make a capture if it's worse than doing nothing
+    while (d < 31) {
+        int attacker = see.leastValuableAttacker(target, side);
+        if (attacker < 0) break;
+        
+        // The king can't recapture on a defended square
+        if (see.types[attacker] == PieceType::KING && see.leastValuableAttacker(target, other) >= 0) break;
+        
+        // Speculative gain if the side recaptures, resolved below
+        d++;
+        gain[d] = getPieceValue(onSquare) - gain[d - 1];
+        onSquare = see.types[attacker];
+        see.types[attacker] = PieceType::NONE;
+        std::swap(side, other);
+    }
+    
+    // Each side may stop the exchange instead of recapturing
+    for (; d > 0; d--) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+    }
+    
+    return gain[0];
 }
 
-int Engine::getDepthAdjustment(const Move& move, const Board& board, bool isPVMove, int moveIndex) const {
-    // For PV moves, no reduction
-    if (isPVMove) {
-        return 0;
-    }
+// Check if the SEE value of a move is at least the threshold, stopping as soon
+// as the result is known
+bool Engine::seeGE(const Board& board, const Move& move, int threshold) const {
+    auto movingPiece = board.getPieceAt(move.from);
+    if (!movingPiece) return threshold <= 0;
     
-    // Losing captures shouldn't get full depth
     auto capturedPiece = board.getPieceAt(move.to);
-    if (capturedPiece && seeCapture(board, move) < 0) {
-        return -1;
+    bool enPassant = !capturedPiece && movingPiece->getType() == PieceType::PAWN &&
+                     move.to == board.getEnPassantTarget();
+    
+    // Castling can't lose material
+    if (movingPiece->getType() == PieceType::KING && std::abs(move.to.col - move.from.col) == 2) {
+        return threshold <= 0;
     }
     
-    // First few moves should get full depth
-    if (moveIndex < 3) {
-        return 0;
+    int captureValue = capturedPiece ? getPieceValue(capturedPiece->getType()) : enPassant ? PAWN_VALUE : 0;
+    PieceType onSquare = movingPiece->getType();
+    if (move.promotion != PieceType::NONE) {
+        captureValue += getPieceValue(move.promotion) - PAWN_VALUE;
+        onSquare = move.promotion;
     }
     
-    // Late moves get progressively less depth
-    int reduction = 0;
+    // Even winning the piece outright doesn't reach the threshold
+    int swap = captureValue - threshold;
+    if (swap < 0) return false;
+    
+    // Still at or above the threshold after losing the moved piece
+    swap = getPieceValue(onSquare) - swap;
+    if (swap <= 0) return true;
     
-    // Base reduction on move index
-    if (moveIndex >= 3) {
-        reduction = 1;
+    SeeBoard see(board);
+    int target = move.to.row * 8 + move.to.col;
+    see.types[move.from.row * 8 + move.from.col] = PieceType::NONE;
+    if (enPassant) {
+        see.types[move.from.row * 8 + move.to.col] = PieceType::NONE;
     }
-    if (moveIndex >= 6) {
-        reduction = 2;
+    
+    // res is true while the side that made the move is at or above the threshold
+    Color side = movingPiece->getColor();
+    bool res = true;
+    
+    while (true) {
+        side = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        
+        int attacker = see.leastValuableAttacker(target, side);
+        if (attacker < 0) break;
+        
+        res = !res;
+        
+        // A king capture only stands if the other side has no attackers left
+        if (see.types[attacker] == PieceType::KING) {
+            Color other = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
+            return see.leastValuableAttacker(target, other) >= 0 ? !res : res;
+        }
+        
+        swap = getPieceValue(see.types[attacker]) - swap;
+        if (swap < static_cast<int>(res)) break;
+        
+        see.types[attacker] = PieceType::NONE;
     }
-    if (moveIndex >= 12) {
-        reduction = 3;
+    
+    return res;
+}
+
+// Precompute the late move reduction table: reductions grow with the logarithm
+// of both the remaining depth and the move's position in the ordering
+void Engine::initReductions() {
+    for (int depth = 0; depth < MAX_PLY; depth++) {
+        for (int moveIndex = 0; moveIndex < LMR_MAX_MOVES; moveIndex++) {
+            if (depth == 0 || moveIndex == 0) {
+                reductions[depth][moveIndex] = 0;
+            } else {
+                reductions[depth][moveIndex] =
+                    static_cast<int>(0.75 + std::log(depth) * std::log(moveIndex) / 2.25);
+            }
+        }
     }
+}
+
+int Engine::getReduction(const Board& board, int depth, int moveIndex, bool isPVNode,
+                         bool isKiller, bool isGoodCapture, int historyScore) const {
+    // Only quiet moves and losing captures are reduced
+    if (isGoodCapture) {
+        return 0;
+    }
+    
+    int reduction = reductions[std::min(depth, MAX_PLY - 1)][std::min(moveIndex, LMR_MAX_MOVES - 1)];
     
-    // Don't reduce too much at low depths
-    reduction = std::min(reduction, 2);
+    // Reduce less in PV nodes, for killer moves and for moves giving check
+    if (isPVNode) reduction--;
+    if (isKiller) reduction--;
+    if (board.isInCheck()) reduction--;
     
-    return -reduction;
+    // Reduce less for moves with a good history, more for a poor one
+    reduction -= historyScore / LMR_HISTORY_DIVISOR;
+    
+    // Never drop straight into quiescence search
+    return std::max(0, std::min(reduction, depth - 2));
 }
 
 // Get the approximate value of a piece for SEE
@@ -327,10 +622,10 @@ bool Engine::isKillerMove(const Move& move, int ply) const {
 }
 
 // Store a counter move
-void Engine::storeCounterMove(const Move& lastMove, const Move& counterMove) {
+void Engine::storeCounterMove(const Board& board, const Move& lastMove, const Move& counterMove) {
     if (!lastMove.from.isValid() || !lastMove.to.isValid()) return;
     
-    auto piece = game.getBoard().getPieceAt(lastMove.to);
+    auto piece = board.getPieceAt(lastMove.to);
     if (!piece) return;
     
     int pieceType = static_cast<int>(piece->getType());
@@ -342,10 +637,10 @@ void Engine::storeCounterMove(const Move& lastMove, const Move& counterMove) {
 }
 
 // Get counter move for an opponent's move
-Move Engine::getCounterMove(const Move& lastMove) const {
+Move Engine::getCounterMove(const Board& board, const Move& lastMove) const {
     if (!lastMove.from.isValid() || !lastMove.to.isValid()) return Move(Position(), Position());
     
-    auto piece = game.getBoard().getPieceAt(lastMove.to);
+    auto piece = board.getPieceAt(lastMove.to);
     if (!piece) return Move(Position(), Position());
     
     int pieceType = static_cast<int>(piece->getType());
@@ -356,28 +651,76 @@ Move Engine::getCounterMove(const Move& lastMove) const {
     return counterMoves[pieceType][color][fromIdx][toIdx];
 }
 
-// Update history heuristic table for a move that caused beta cutoff
-void Engine::updateHistoryScore(const Move& move, int depth, Color color) {
-    int colorIdx = (color == Color::WHITE) ? 0 : 1;
+// Index of a piece moving to a square in the continuation history
+int Engine::pieceSquareIndex(const Piece& piece, const Position& to) {
+    int pieceIdx = static_cast<int>(piece.getColor()) * 6 + static_cast<int>(piece.getType());
+    return pieceIdx * 64 + to.row * 8 + to.col;
+}
+
+// History bonus for a cutoff at the given depth
+int Engine::historyBonus(int depth) {
+    return std::min(32 * depth * depth, HISTORY_BONUS_MAX);
+}
+
+// Gravity update: the closer an entry is to +-HISTORY_MAX, the less a bonus in
+// the same direction moves it, so entries saturate instead of overflowing
+template <typename T>
+static void applyHistoryBonus(T& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / HISTORY_MAX;
+}
+
+// Update the history and continuation history of a quiet move
+void Engine::updateQuietHistory(const Board& board, const Move& move, int ply, int bonus) {
+    auto piece = board.getPieceAt(move.from);
+    if (!piece) return;
+    
+    int colorIdx = (piece->getColor() == Color::WHITE) ? 0 : 1;
     int fromIdx = move.from.row * 8 + move.from.col;
     int toIdx = move.to.row * 8 + move.to.col;
+    applyHistoryBonus(historyTable[colorIdx][fromIdx][toIdx], bonus);
     
-    // Bonus based on depth - deeper searches get higher bonuses
-    int bonus = depth * depth;
-    
-    // Increase history score, but prevent overflow
-    historyTable[colorIdx][fromIdx][toIdx] += bonus;
+    // Moves one and two plies back (own and opponent's previous moves)
+    int index = pieceSquareIndex(*piece, move.to);
+    for (int back = 1; back <= 2 && ply - back >= 0; back++) {
+        if (movedPieceSquares[ply - back] >= 0) {
+            applyHistoryBonus(continuationHistory[movedPieceSquares[ply - back]][index], bonus);
+        }
+    }
+}
+
+// Update the capture history of a capture
+void Engine::updateCaptureHistory(const Board& board, const Move& move, int bonus) {
+    auto piece = board.getPieceAt(move.from);
+    if (!piece) return;
     
-    // Prevent overflow by scaling down if the score gets too high
-    if (historyTable[colorIdx][fromIdx][toIdx] > 10000) {
-        for (int c = 0; c < 2; c++) {
-            for (int from = 0; from < 64; from++) {
-                for (int to = 0; to < 64; to++) {
-                    historyTable[c][from][to] /= 2;
-                }
+    // En passant captures a pawn on an empty square; a promotion without a
+    // capture has no capture history
+    auto captured = board.getPieceAt(move.to);
+    if (!captured && move.promotion != PieceType::NONE) return;
+    int capturedType = captured ? static_cast<int>(captured->getType()) : static_cast<int>(PieceType::PAWN);
+    int pieceIdx = static_cast<int>(piece->getColor()) * 6 + static_cast<int>(piece->getType());
+    applyHistoryBonus(captureHistory[pieceIdx][move.to.row * 8 + move.to.col][capturedType], bonus);
+}
+
+// Scale the history tables by historyAgingPercent
+void Engine::ageHistoryTables() {
+    if (historyAgingPercent == 100) return;
+    
+    for (int color = 0; color < 2; color++) {
+        for (int from = 0; from < 64; from++) {
+            for (int to = 0; to < 64; to++) {
+                historyTable[color][from][to] = historyTable[color][from][to] * historyAgingPercent / 100;
             }
         }
     }
+    int16_t* continuation = &continuationHistory[0][0];
+    for (int i = 0; i < 12 * 64 * 12 * 64; i++) {
+        continuation[i] = static_cast<int16_t>(continuation[i] * historyAgingPercent / 100);
+    }
+    int16_t* capture = &captureHistory[0][0][0];
+    for (int i = 0; i < 12 * 64 * 6; i++) {
+        capture[i] = static_cast<int16_t>(capture[i] * historyAgingPercent / 100);
+    }
 }
 
 // Get the history score for a move
@@ -389,6 +732,34 @@ int Engine::getHistoryScore(const Move& move, Color color) const {
     return historyTable[colorIdx][fromIdx][toIdx];
 }
 
+// History plus continuation history of a quiet move
+int Engine::getQuietHistoryScore(const Board& board, const Move& move, int ply) const {
+    int score = getHistoryScore(move, board.getSideToMove());
+    
+    auto piece = board.getPieceAt(move.from);
+    if (!piece) return score;
+    
+    int index = pieceSquareIndex(*piece, move.to);
+    for (int back = 1; back <= 2 && ply - back >= 0; back++) {
+        if (movedPieceSquares[ply - back] >= 0) {
+            score += continuationHistory[movedPieceSquares[ply - back]][index];
+        }
+    }
+    return score;
+}
+
+// Capture history of a capture
+int Engine::getCaptureHistoryScore(const Board& board, const Move& move) const {
+    auto piece = board.getPieceAt(move.from);
+    if (!piece) return 0;
+    
+    auto captured = board.getPieceAt(move.to);
+    if (!captured && move.promotion != PieceType::NONE) return 0;
+    int capturedType = captured ? static_cast<int>(captured->getType()) : static_cast<int>(PieceType::PAWN);
+    int pieceIdx = static_cast<int>(piece->getColor()) * 6 + static_cast<int>(piece->getType());
+    return captureHistory[pieceIdx][move.to.row * 8 + move.to.col][capturedType];
+}
+
 // Check if a move is part of the principal variation
 bool Engine::isPVMove(const Move& move, const std::vector<Move>& pv, int ply) const {
     if (pv.size() <= static_cast<size_t>(ply)) return false;
@@ -400,142 +771,59 @@ bool Engine::isPVMove(const Move& move, const std::vector<Move>& pv, int ply) co
             pvMove.to.col == move.to.col);
 }
 
-// Get score for move ordering
-int Engine::getMoveScore(const Move& move, const Board& board, const Move& ttMove, 
-                        const std::vector<Move>& pv, int ply, Color sideToMove, 
-                        const Move& lastMove) const {
-    // 1. Transposition table move
-    if (ttMove.from.isValid() && ttMove.to.isValid() &&
-        ttMove.from.row == move.from.row && ttMove.from.col == move.from.col &&
-        ttMove.to.row == move.to.row && ttMove.to.col == move.to.col) {
-        return 10000000;
-    }
-    
-    // 2. Principal variation move
-   for (int d = depth; d >= 1; d--) {
-        if (isPVMove(move, d, ply)) {
-            return 9000000 + d * 1000; // PV moves from deeper searches get higher priority
-        }
-    }
-    
-    // 3. Captures (scored by MVV-LVA or SEE)
-    auto movingPiece = board.getPieceAt(move.from);
-    auto capturedPiece = board.getPieceAt(move.to);
-    
-    if (capturedPiece) {
-        // Calculate Static Exchange Evaluation score
-        int seeScore = seeCapture(board, move);
-        
-        // If it's a good capture (positive SEE)
-        if (seeScore > 0) {
-            return 4000000 + seeScore;
-        } 
-        // Still prioritize captures, but lower than good captures
-        else {
-            return 3000000 + getMVVLVAScore(movingPiece->getType(), capturedPiece->getType());
-        }
-    }
-    
-    // 4. Counter move
-    if (lastMove.from.isValid() && lastMove.to.isValid()) {
-        Move counter = getCounterMove(lastMove);
-        if (counter.from.isValid() && counter.to.isValid() &&
-            counter.from.row == move.from.row && counter.from.col == move.from.col &&
-            counter.to.row == move.to.row && counter.to.col == move.to.col) {
-            return 2500000;
-        }
-    }
-    
-    // 5. Killer moves
-    if (isKillerMove(move, ply)) {
-        // First killer move gets slightly higher score than second
-        if (killerMoves[ply][0].from.row == move.from.row && 
-            killerMoves[ply][0].from.col == move.from.col && 
-            killerMoves[ply][0].to.row == move.to.row && 
-            killerMoves[ply][0].to.col == move.to.col) {
-            return 2000100;
-        }
-        return 2000000;
-    }
-    
-    // 6. History heuristic for non-captures
-    return getHistoryScore(move, sideToMove);
-}
-
 int Engine::quiescenceSearch(Board& board, int alpha, int beta, uint64_t hashKey, int ply) {
     // Track nodes searched
-    nodesSearched++;
+    stats.nodes++;
+    stats.qnodes++;
+    stats.selDepth = std::max(stats.selDepth, ply);
     
     // Maximum recursion depth check
     if (ply >= MAX_PLY - 1)
         return evaluatePosition(board);
     
-    // Stand-pat score (evaluate the current position without making any moves)
-    int standPat = evaluatePosition(board);
-    
-    // Beta cutoff
-    if (standPat >= beta)
-        return beta;
-    
-    // Update alpha if stand-pat score is better
-    if (standPat > alpha)
-        alpha = standPat;
-    
-    // Generate capturing moves
-    std::vector<Move> capturingMoves;
-    
-    // Get all legal moves
-    auto legalMoves = board.generateLegalMoves();
-    
-    // Filter only capturing moves
-    for (const auto& move : legalMoves) {
-        auto capturedPiece = board.getPieceAt(move.to);
-        if (capturedPiece || 
-            (board.getPieceAt(move.from)->getType() == PieceType::PAWN && 
-             move.to == board.getEnPassantTarget())) {
-            capturingMoves.push_back(move);
-        }
+    // Use the transposition table for cutoffs and the hash move
+    Move ttMove;
+    int ttScore;
+    bool ttFound;
+    stats.ttProbes++;
+    if (transpositionTable.probe(hashKey, 0, alpha, beta, ttScore, ttMove, ply, ttFound)) {
+        stats.ttHits++;
+        stats.ttCutoffs++;
+        return ttScore;
     }
+    if (ttFound) stats.ttHits++;
     
-    // Score and sort the moves
-    std::vector<std::pair<int, Move>> scoredMoves;
-    for (const auto& move : capturingMoves) {
-        int moveScore = 0;
-        
-        auto movingPiece = board.getPieceAt(move.from);
-        auto capturedPiece = board.getPieceAt(move.to);
+    // In check there is no standing pat: every evasion is searched, quiet
+    // ones included, and having none is mate
+    bool inCheck = board.isInCheck();
+    
+    if (!inCheck) {
+        // Stand-pat score (evaluate the current position without making any moves)
+        int standPat = evaluatePosition(board);
         
-        if (capturedPiece) {
-            // MVV-LVA scoring for captures
-            moveScore = getMVVLVAScore(movingPiece->getType(), capturedPiece->getType());
-            
-            // Static Exchange Evaluation (SEE)
-            int seeScore = seeCapture(board, move);
-            if (seeScore < 0) {
-                // Skip bad captures at deeper ply depths
-                if (ply > 2 && !board.isInCheck()) continue;
-                
-                // Penalize bad captures, but still consider them
-                moveScore += seeScore;
-            }
-        } else if (board.getPieceAt(move.from)->getType() == PieceType::PAWN && 
-                  move.to == board.getEnPassantTarget()) {
-            // En passant capture
-            moveScore = getMVVLVAScore(movingPiece->getType(), PieceType::PAWN);
-        }
+        // Beta cutoff
+        if (standPat >= beta)
+            return beta;
         
-        scoredMoves.push_back(std::make_pair(moveScore, move));
+        // Update alpha if stand-pat score is better
+        if (standPat > alpha)
+            alpha = standPat;
     }
     
-    // Sort moves by score (descending)
-    std::sort(scoredMoves.begin(), scoredMoves.end(),
-              [](const std::pair<int, Move>& a, const std::pair<int, Move>& b) {
-                  return a.first > b.first;
-              });
+    // Out of check, captures and promotions are generated lazily, best first.
+    // Losing captures are only tried close to the root. In check, the evasion
+    // picker needs none of the per-ply killer or counter move state.
+    MovePicker picker = inCheck ? MovePicker(board, *this, ttMove)
+                                : MovePicker(board, *this, ttMove, ply <= 2);
     
     // Make each move and recursively search
-    for (const auto& scoredMove : scoredMoves) {
-        const Move& move = scoredMove.second;
+    Move move;
+    int legalMoves = 0;
+    while (picker.next(move)) {
+        // Piece and destination for the continuation history of the next ply
+        auto piece = board.getPieceAt(move.from);
+        if (!piece)
+            continue;
         
         // Save board state for unmaking move
         BoardState previousState;
@@ -543,9 +831,11 @@ int Engine::quiescenceSearch(Board& board, int alpha, int beta, uint64_t hashKey
         // Make the move
         if (!board.makeMove(move, previousState))
             continue;
+        legalMoves++;
+        movedPieceSquares[ply] = pieceSquareIndex(*piece, move.to);
         
-        // Calculate new hash key
-        uint64_t newHashKey = Zobrist::updateHashKey(hashKey, move, board);
+        // Hash key of the position after the move
+        uint64_t newHashKey = board.getHashKey();
         
         // Recursively search
         int score = -quiescenceSearch(board, -beta, -alpha, newHashKey, ply + 1);
@@ -562,135 +852,140 @@ int Engine::quiescenceSearch(Board& board, int alpha, int beta, uint64_t hashKey
             alpha = score;
     }
     
+    if (inCheck && legalMoves == 0) {
+        return -MATE_SCORE + ply;
+    }
+    
     return alpha;
 }
-    
-    // If not in check, proceed with selective quiescence search using staged move generation
-    
-    if (qMoves.empty())
-        return standPat;
-    
-    // Score and sort the moves
-    std::vector<std::pair<int, Move>> scoredMoves;
-    for (const auto& move : qMoves) {
-        // Score the move
-        int moveScore = 0;
-        
-        auto movingPiece = board.getPieceAt(move.from);
-        auto capturedPiece = board.getPieceAt(move.to);
-        
-        bool isCapture = capturedPiece != nullptr || 
-                         (movingPiece->getType() == PieceType::PAWN && 
-                          move.to == board.getEnPassantTarget());
-        
-        // Delta pruning - skip captures that can't improve alpha
-        if (isCapture && !inCheck && qDepth > 0) {
-            // Get the maximum possible material gain from this capture
-            int captureValue = 0;
-            if (capturedPiece) {
-                captureValue = getPieceValue(capturedPiece->getType());
-            } else if (move.to == board.getEnPassantTarget()) {
-                captureValue = PAWN_VALUE;
-            }
+
+// Pieces of the side to move that can give check and the opponent's king,
+// so the pruning below can tell whether a quiet move gives check without
+// making it
+struct CheckInfo {
+    uint64_t occupied;
+    uint64_t diagonalSliders;  // Own bishops and queens
+    uint64_t straightSliders;  // Own rooks and queens
+    int kingSquare;            // Opponent's king (-1 if there is none)
+    int color;                 // Side to move (0 = white)
+    
+    explicit CheckInfo(const Board& board)
+        : occupied(0), diagonalSliders(0), straightSliders(0), kingSquare(-1),
+          color(board.getSideToMove() == Color::WHITE ? 0 : 1) {
+        for (int sq = 0; sq < 64; sq++) {
+            auto piece = board.getPieceAt(Position(sq / 8, sq % 8));
+            if (!piece) continue;
             
-            // Add potential promotion bonus
-            int promotionBonus = 0;
-            if (movingPiece->getType() == PieceType::PAWN && 
-                (move.to.row == 0 || move.to.row == 7)) {
-                promotionBonus = QUEEN_VALUE - PAWN_VALUE;
+            occupied |= 1ULL << sq;
+            if (piece->getColor() != board.getSideToMove()) {
+                if (piece->getType() == PieceType::KING) kingSquare = sq;
+                continue;
             }
-            
-            // Delta margin - a buffer to account for positional gains
-            const int DELTA_MARGIN = 200;
-            
-            // Skip if even the maximum possible gain can't improve alpha
-            if (standPat + captureValue + promotionBonus + DELTA_MARGIN <= alpha) {
-                continue;  // Skip this capture - it can't improve alpha
+            if (piece->getType() == PieceType::BISHOP || piece->getType() == PieceType::QUEEN) {
+                diagonalSliders |= 1ULL << sq;
             }
-        }
-        
-        if (capturedPiece) {
-            // MVV-LVA scoring for captures
-            moveScore = 10000000 + getMVVLVAScore(movingPiece->getType(), capturedPiece->getType());
-            
-            // Static Exchange Evaluation (SEE)
-            int seeScore = seeCapture(board, move);
-            if (seeScore < 0) {
-                // Skip bad captures at deeper ply depths
-                if (qDepth > 2 && !inCheck) continue;
-                
-                // Penalize bad captures, but still consider them
-                moveScore += seeScore;
+            if (piece->getType() == PieceType::ROOK || piece->getType() == PieceType::QUEEN) {
+                straightSliders |= 1ULL << sq;
             }
-        } else if (board.getPieceAt(move.from)->getType() == PieceType::PAWN && 
-                  move.to == board.getEnPassantTarget()) {
-            // En passant capture
-            moveScore = 10000000 + getMVVLVAScore(movingPiece->getType(), PieceType::PAWN);
-        } else {
-            // Non-capture move (likely a check)
-            // Score lower than captures but still consider
-            moveScore = 1000000;
         }
-        
-        scoredMoves.push_back(std::make_pair(moveScore, move));
     }
     
-    // Sort moves by score (descending)
-    std::sort(scoredMoves.begin(), scoredMoves.end(),
-              [](const std::pair<int, Move>& a, const std::pair<int, Move>& b) {
-                  return a.first > b.first;
-              });
-    
-    // Make each move and recursively search
-    for (const auto& scoredMove : scoredMoves) {
-        const Move& move = scoredMove.second;
-        
-        // Save board state for unmaking move
-        BoardState previousState;
+    // Check if a quiet move (no capture or promotion) gives check, either
+    // directly or by uncovering a slider behind the moved piece
+    bool givesCheck(const Move& move, PieceType type) const {
+        if (kingSquare < 0) return false;
         
-        // Make the move
-        if (!board.makeMove(move, previousState))
-            continue;
-        
-        // Calculate new hash key
-        uint64_t newHashKey = Zobrist::updateHashKey(hashKey, move, board);
+        uint64_t king = 1ULL << kingSquare;
+        uint64_t fromBit = 1ULL << (move.from.row * 8 + move.from.col);
+        int to = move.to.row * 8 + move.to.col;
+        uint64_t toBit = 1ULL << to;
         
-        // Apply adaptive depth - reduce depth for specific move types
-        int newQDepth = qDepth + 1;
-        
-        // Recursively search
-        int score = -quiescenceSearch(board, -beta, -alpha, newHashKey, ply + 1, newQDepth);
-        
-        // Unmake the move
-        board.unmakeMove(move, previousState);
+        // Sliders and occupancy after the move
+        uint64_t occ = (occupied & ~fromBit) | toBit;
+        uint64_t diagonal = diagonalSliders & ~fromBit;
+        uint64_t straight = straightSliders & ~fromBit;
         
-        // Beta cutoff
-        if (score >= beta)
-            return beta;
+        switch (type) {
+            case PieceType::PAWN:
+                if (Attacks::pawn(color, to) & king) return true;
+                break;
+            case PieceType::KNIGHT:
+                if (Attacks::knight(to) & king) return true;
+                break;
+            case PieceType::BISHOP:
+                diagonal |= toBit;
+                break;
+            case PieceType::ROOK:
+                straight |= toBit;
+                break;
+            case PieceType::QUEEN:
+                diagonal |= toBit;
+                straight |= toBit;
+                break;
+            case PieceType::KING:
+                // Castling moves the rook next to the king
+                if (std::abs(move.to.col - move.from.col) == 2) {
+                    bool kingside = move.to.col > move.from.col;
+                    uint64_t rookFrom = 1ULL << (move.from.row * 8 + (kingside ? 7 : 0));
+                    uint64_t rookTo = 1ULL << (move.from.row * 8 + (kingside ? 5 : 3));
+                    occ = (occ & ~rookFrom) | rookTo;
+                    straight = (straight & ~rookFrom) | rookTo;
+                }
+                break;
+            default:
+                break;
+        }
         
-        // Update alpha
-        if (score > alpha)
-            alpha = score;
+        return (Attacks::bishop(kingSquare, occ) & diagonal) || (Attacks::rook(kingSquare, occ) & straight);
     }
-    
-    return alpha;
-}
+};
 
-int Engine::pvSearch(Board& board, int depth, int alpha, int beta, bool maximizingPlayer, 
-                     std::vector<Move>& pv, uint64_t hashKey, int ply, Move lastMove) {
+template <SearchNodeType searchNode>
+int Engine::negamax(Board& board, int depth, int alpha, int beta,
+                    std::vector<Move>& pv, int ply, Move lastMove, Move excludedMove) {
+    constexpr bool rootNode = searchNode == SearchNodeType::ROOT;
+    constexpr bool pvNode = searchNode != SearchNodeType::NON_PV;
+    bool excluded = excludedMove.from.isValid();
+    
     // Track nodes searched
-    nodesSearched++;
+    stats.nodes++;
+    stats.selDepth = std::max(stats.selDepth, ply);
+    
+    if (!rootNode) {
+        // Draw by the fifty-move rule or by repeating a position of the game or the search path
+        if (board.getHalfMoveClock() >= 100 || isRepetition(board)) {
+            return 0;
+        }
+        
+        // Mate distance pruning: no result here can beat mating sooner than
+        // this ply or being mated later than the next one
+        alpha = std::max(alpha, -MATE_SCORE + ply);
+        beta = std::min(beta, MATE_SCORE - ply - 1);
+        if (alpha >= beta) {
+            return alpha;
+        }
+    }
     
-    // Check transposition table for this position
+    // Check transposition table for this position. Searches without the
+    // excluded move have their own entries.
+    uint64_t hashKey = board.getHashKey();
+    if (excluded) {
+        hashKey ^= Zobrist::excludedMoveKey(excludedMove);
+    }
     int originalAlpha = alpha;
-    Move ttMove(Position(), Position());
+    Move ttMove;
     int score;
     
     pv.clear();
     
-    // Probe the transposition table
-    if (ply > 0 && transpositionTable.probe(hashKey, depth, alpha, beta, score, ttMove)) {
-        return score; // Return cached result if available (but don't use TT at root)
+    // Probe the transposition table (but don't use TT cutoffs at root)
+    bool ttFound;
+    stats.ttProbes++;
+    bool ttUsable = transpositionTable.probe(hashKey, depth, alpha, beta, score, ttMove, ply, ttFound);
+    if (ttFound) stats.ttHits++;
+    if (ttUsable && !rootNode) {
+        stats.ttCutoffs++;
+        return score;
     }
     
     // Check for search termination conditions
@@ -698,618 +993,439 @@ int Engine::pvSearch(Board& board, int depth, int alpha, int beta, bool maximizi
         return evaluatePosition(board);
     }
     
-    // If we've reached the maximum depth, use quiescence search
+    bool inCheck = board.isInCheck();
+    
+    // If we've reached the maximum depth, use quiescence search. The static eval
+    // doesn't detect mate, so positions in check get one more ply of evasions.
+    bool horizonEvasion = false;
     if (depth <= 0) {
-        return quiescenceSearch(board, alpha, beta, hashKey, ply);
+        if (!inCheck) {
+            return quiescenceSearch(board, alpha, beta, board.getHashKey(), ply);
+        }
+        depth = 1;
+        horizonEvasion = true;
     }
     
-    // Check if we should extend the search depth
-    int extension = 0;
+    // Static evaluation for the pruning decisions below. The position is
+    // improving if it evaluates better than two plies ago.
+    int staticEval = inCheck ? NO_SCORE : evaluatePosition(board);
+    staticEvals[ply] = staticEval;
+    bool improving = !inCheck && (ply < 2 || staticEval > staticEvals[ply - 2]);
+    
+    // Reverse futility pruning (static null move) - at shallow depth, a static
+    // eval above beta by a depth-dependent margin is unlikely to drop below it
+    if (reverseFutilityEnabled && !pvNode && !inCheck && !excluded && depth <= RFP_MAX_DEPTH &&
+        std::abs(beta) < DECISIVE_BOUND &&
+        staticEval - RFP_MARGIN * (depth - (improving ? 1 : 0)) >= beta) {
+        stats.reverseFutilityCuts++;
+        return staticEval;
+    }
     
-    // 1. Check extension - extend search when in check
-    if (board.isInCheck()) {
-        extension = 1;
+    // Null-move pruning - if the side to move can pass and a reduced search still
+    // fails high, the position is good enough to cut. A null move is passed to the
+    // child as an empty lastMove, so two null moves are never made in a row.
+    bool afterNullMove = !rootNode && !lastMove.from.isValid();
+    if (!pvNode && !inCheck && !excluded && !afterNullMove && depth >= NULL_MOVE_MIN_DEPTH &&
+        (ply >= nullMoveMinPly || board.getSideToMove() != nullMoveColor) &&
+        hasNonPawnMaterial(board, board.getSideToMove())) {
+        if (staticEval >= beta) {
+            // Reduce more at higher depths and when the eval is well above beta
+            int R = 3 + depth / 6 + std::min(3, (staticEval - beta) / 200);
+            
+            BoardState nullState;
+            movedPieceSquares[ply] = -1;
+            stats.nullMoveTries++;
+            board.makeNullMove(nullState);
+            int savedNullMoveKeyIndex = nullMoveKeyIndex;
+            nullMoveKeyIndex = static_cast<int>(positionKeys.size());
+            positionKeys.push_back(board.getHashKey());
+            std::vector<Move> nullPV;
+            int nullScore = -negamax<SearchNodeType::NON_PV>(board, depth - R - 1, -beta, -beta + 1,
+                                                             nullPV, ply + 1, Move());
+            positionKeys.pop_back();
+            nullMoveKeyIndex = savedNullMoveKeyIndex;
+            board.unmakeNullMove(nullState);
+            
+            if (nullScore >= beta) {
+                // Don't return unproven mate scores
+                if (nullScore >= DECISIVE_BOUND) {
+                    nullScore = beta;
+                }
+                
+                if (depth < NULL_MOVE_VERIFY_DEPTH) {
+                    stats.nullMoveCutoffs++;
+                    return nullScore;
+                }
+                
+                // Zugzwang verification at high depth: search this node again at
+                // reduced depth with null moves disabled for the side to move.
+                // A verification can run inside another one, so the outer guard
+                // is restored afterwards rather than cleared.
+                int savedMinPly = nullMoveMinPly;
+                Color savedColor = nullMoveColor;
+                nullMoveMinPly = ply + 3 * (depth - R) / 4;
+                nullMoveColor = board.getSideToMove();
+                std::vector<Move> verifyPV;
+                int verifyScore = negamax<SearchNodeType::NON_PV>(board, depth - R, beta - 1, beta,
+                                                                  verifyPV, ply, lastMove);
+                nullMoveMinPly = savedMinPly;
+                nullMoveColor = savedColor;
+                
+                if (verifyScore >= beta) {
+                    stats.nullMoveCutoffs++;
+                    return nullScore;
+                }
+            }
+        }
     }
     
-    // Other extensions will be applied after move generation
+    // Check if we should extend the search depth
+    int extension = 0;
     
-    // If the game is over, return the evaluation
-    if (board.isCheckmate() || board.isStalemate()) {
-        return evaluatePosition(board);
+    // 1. Check extension - extend search when in check. Evasions at the horizon
+    // already got their extra ply; extending them again lets a run of checks
+    // keep the depth from ever reaching zero.
+    if (inCheck && !horizonEvasion) {
+        extension = 1;
     }
     
-    // Generate all legal moves
-    std::vector<Move> legalMoves = board.generateLegalMoves();
+    // Other extensions are applied per move
     
-    // If there are no legal moves, either checkmate or stalemate
-    if (legalMoves.empty()) {
-        if (board.isInCheck()) {
-            // Checkmate (worst possible score, adjusted for distance to mate)
-            return maximizingPlayer ? -100000 + ply : 100000 - ply;
-        } else {
-            // Stalemate
-            return 0;
-        }
-    }
+    // The hash move is a singular extension candidate when its entry is a
+    // lower bound (or exact) from a search not much shallower than this one
+    TTEntry ttEntry;
+    bool singularCandidate = !rootNode && !excluded && depth >= SINGULAR_MIN_DEPTH &&
+                             ttMove.from.isValid() && transpositionTable.lookup(hashKey, ttEntry) &&
+                             ttEntry.type != NodeType::ALPHA &&
+                             ttEntry.depth >= depth - SINGULAR_TT_DEPTH_MARGIN &&
+                             std::abs(ttEntry.score) < DECISIVE_BOUND;
     
-    // 2. Singular Move Extension - if only one legal move, extend
-    if (legalMoves.size() == 1 && depth >= 2) {
-        extension = std::max(extension, 1);
+    // Without a hash move, follow the principal variation of the previous iteration
+    if (pvNode && !ttMove.from.isValid() && static_cast<size_t>(ply) < principalVariation.size()) {
+        ttMove = principalVariation[ply];
     }
     
-    // Score each move for ordering
-    std::vector<std::pair<int, Move>> scoredMoves;
-    for (const auto& move : legalMoves) {
-        int moveScore = getMoveScore(move, board, ttMove, principalVariation, ply, board.getSideToMove(), lastMove);
-        
-        // Early pruning of very bad captures
-        if (depth >= 3) {
-            auto capturedPiece = board.getPieceAt(move.to);
-            if (capturedPiece) {
-                int seeScore = seeCapture(board, move);
-                // If SEE indicates a very bad capture, don't even consider this move
-                if (seeScore < -PAWN_VALUE * 2) {
-                    continue;
-                }
-            }
-        }
-        
-        scoredMoves.push_back(std::make_pair(moveScore, move));
+    // Internal iterative reduction - a deep node with no move to try first (no
+    // hash move, and off the previous principal variation) is searched one ply
+    // shallower; the table then holds a best move if it is searched again
+    if (!excluded && !ttMove.from.isValid() && depth >= IIR_MIN_DEPTH) {
+        depth--;
     }
     
-    // Sort moves by score (descending)
-    std::sort(scoredMoves.begin(), scoredMoves.end(), 
-              [](const std::pair<int, Move>& a, const std::pair<int, Move>& b) {
-                  return a.first > b.first;
-              });
-    
     NodeType nodeType = NodeType::ALPHA;
-    Move localBestMove = legalMoves.empty() ? Move(Position(), Position()) : legalMoves[0];
-    bool foundPV = false;
+    Move localBestMove;
+    int bestScore = std::numeric_limits<int>::min();
+    int moveCount = 0;
     
     // This will be used to store the principal variation
     std::vector<Move> childPV;
     
-    if (maximizingPlayer) {
-        int maxEval = std::numeric_limits<int>::min();
+    // Moves searched without a cutoff, for the history malus
+    std::vector<Move> quietsTried;
+    std::vector<Move> capturesTried;
+    
+    // Moves are generated in stages and picked best first
+    MovePicker picker(board, *this, ttMove, ply, lastMove);
+    Move move;
+    
+    // Built on the first quiet move that could be pruned
+    std::optional<CheckInfo> checkInfo;
+    
+    while (picker.next(move)) {
+        // The move being verified by a singular extension search is skipped
+        if (excluded && move == excludedMove) {
+            continue;
+        }
         
-        for (size_t i = 0; i < scoredMoves.size(); i++) {
-            const Move& move = scoredMoves[i].second;
-
-            // Determine if this is a PV move (part of the principal variation)
-            bool isPVMove = isPVMove(move, principalVariation, ply);
-            
-            // Calculate depth adjustment (reduction or extension)
-            int moveExtension = extension;
-            
-            
-            // 3. Recapture Extension - extend when recapturing at the same square
-            if (lastMove.to.isValid() && move.to == lastMove.to) {
+        // In multi-PV mode, the first moves of the lines already found are skipped
+        if (rootNode && std::find(excludedRootMoves.begin(), excludedRootMoves.end(), move) != excludedRootMoves.end()) {
+            continue;
+        }
+        
+        // Early pruning of very bad captures. Not in check or before a move
+        // has been searched, where they may be the only legal moves.
+        if (depth >= 3 && !inCheck && moveCount > 0 && picker.getStage() == PickerStage::BAD_CAPTURES &&
+            !seeGE(board, move, -PAWN_VALUE * 2)) {
+            continue;
+        }
+        
+        // Shallow-depth pruning of plain quiet moves (not the hash, killer or
+        // counter moves) once a move has been found that doesn't get mated
+        bool prunableQuiet = !rootNode && !inCheck && picker.getStage() == PickerStage::QUIETS &&
+                             move.promotion == PieceType::NONE && moveCount > 0 &&
+                             bestScore > -DECISIVE_BOUND;
+        
+        // Late move count pruning: after enough quiet moves the rest rarely matter.
+        // Futility pruning: a quiet move can't lift a static eval this far below
+        // alpha. Both spare moves that give check, which is found from the
+        // attacks of the moved piece and the sliders behind it, so pruned moves
+        // are never made.
+        bool lateMove = prunableQuiet && lateMovePruningEnabled && depth <= LMP_MAX_DEPTH &&
+                        moveCount >= (3 + depth * depth) / (improving ? 1 : 2);
+        bool futile = prunableQuiet && futilityEnabled && depth <= FUTILITY_MAX_DEPTH &&
+                      staticEval + FUTILITY_MARGIN_BASE + FUTILITY_MARGIN * depth <= alpha;
+        if (lateMove || futile) {
+            if (!checkInfo) checkInfo.emplace(board);
+            auto movingPiece = board.getPieceAt(move.from);
+            if (movingPiece && !checkInfo->givesCheck(move, movingPiece->getType())) {
+                if (lateMove) stats.lateMovePrunes++;
+                else stats.futilityPrunes++;
+                continue;
+            }
+        }
+        
+        // Determine if this is a PV move (part of the principal variation)
+        bool isPV = isPVMove(move, principalVariation, ply);
+        
+        // Calculate depth extension for this move
+        int moveExtension = extension;
+        
+        // 2. Singular extension - search the other moves at reduced depth against a
+        // bound below the hash score. If they all fail low, the hash move is the
+        // only good move and is searched deeper. If even that lowered bound is at
+        // least beta and some other move reaches it, more than one move beats
+        // beta and the node is cut (multi-cut).
+        if (singularCandidate && move == ttMove) {
+            int singularBeta = ttEntry.score - SINGULAR_MARGIN * depth;
+            std::vector<Move> singularPV;
+            int singularScore = negamax<SearchNodeType::NON_PV>(board, (depth - 1) / 2, singularBeta - 1, singularBeta,
+                                                                singularPV, ply, lastMove, move);
+            if (singularScore < singularBeta) {
                 moveExtension = std::max(moveExtension, 1);
+            } else if (singularBeta >= beta) {
+                return singularBeta;
             }
-            
-            // 4. Pawn Push Extension - extend when a pawn makes it to the 7th rank
-            auto piece = board.getPieceAt(move.from);
-            if (piece && piece->getType() == PieceType::PAWN) {
-                int destRow = (board.getSideToMove() == Color::WHITE) ? 6 : 1; // 7th rank
-                if (move.to.row == destRow) {
-                    moveExtension = std::max(moveExtension, 1);
-                }
+        }
+        
+        // 3. Recapture Extension - extend when recapturing at the same square
+        if (lastMove.to.isValid() && move.to == lastMove.to) {
+            moveExtension = std::max(moveExtension, 1);
+        }
+        
+        // 4. Pawn Push Extension - extend when a pawn makes it to the 7th rank
+        auto piece = board.getPieceAt(move.from);
+        if (piece && piece->getType() == PieceType::PAWN) {
+            int destRow = (board.getSideToMove() == Color::WHITE) ? 6 : 1; // 7th rank
+            if (move.to.row == destRow) {
+                moveExtension = std::max(moveExtension, 1);
             }
+        }
 
-            // Progressive deepening - apply depth adjustment for non-first moves
-            int depthAdjustment = 0;
-            if (!foundPV && i > 0) {
-                // Young Brothers Wait - reduce depth for siblings of the first move
-                depthAdjustment = getDepthAdjustment(move, board, isPVMove, i);
-            }
-            
-            // Final depth after adjustments
-            int newDepth = depth - 1 + moveExtension + depthAdjustment;
-            
-            // Ensure we don't go below quiescence search
-            newDepth = std::max(0, newDepth);
-            
-            // Save board state for unmaking move
-            BoardState previousState;
-            
-            // Make the move
-            if (!board.makeMove(move, previousState))
-                continue;
-            
-            // Calculate the new hash key after the move
-            uint64_t newHashKey = Zobrist::updateHashKey(hashKey, move, board);
-            
-            // Recursively evaluate the position with potential extension
-            childPV.clear();
-            int eval;
-            
-            // Full window search for first move, null window for others
-            if (foundPV) {
-                // Try a null window search first
-                eval = -pvSearch(board, depth - 1 + moveExtension, -alpha - 1, -alpha, false, childPV, newHashKey, ply + 1, move);
-                
-                // If we might fail high, do a full window search
-                if (eval > alpha && eval < beta) {
-                    childPV.clear();
-                    eval = -pvSearch(board, depth - 1 + moveExtension, -beta, -alpha, false, childPV, newHashKey, ply + 1, move);
-                }
-            } else {
-                // First move gets a full window search
-                eval = -pvSearch(board, depth - 1 + moveExtension, -beta, -alpha, false, childPV, newHashKey, ply + 1, move);
+        // Depth of the child search after extensions
+        int newDepth = depth - 1 + moveExtension;
+        
+        // Move properties used by late move reductions, read before the move is made
+        bool isTactical = board.isTactical(move);
+        bool isGoodCapture = isTactical && picker.getStage() != PickerStage::BAD_CAPTURES;
+        bool isKiller = isKillerMove(move, ply);
+        int historyScore = isTactical ? 0 : getQuietHistoryScore(board, move, ply);
+        
+        // Save board state for unmaking move
+        BoardState previousState;
+        
+        // Make the move (this also rejects illegal hash, killer and counter moves)
+        if (!board.makeMove(move, previousState))
+            continue;
+        
+        movedPieceSquares[ply] = pieceSquareIndex(*piece, move.to);
+        positionKeys.push_back(board.getHashKey());
+        
+        int i = moveCount++;
+        childPV.clear();
+        int eval;
+        
+        // Full window search for the first move, null window for the others
+        if (i > 0 || !pvNode) {
+            // Late move reduction: search late quiet moves shallower
+            int reduction = 0;
+            if (depth >= LMR_MIN_DEPTH && i >= LMR_MIN_MOVES && !inCheck && !isPV &&
+                move.promotion == PieceType::NONE) {
+                reduction = getReduction(board, depth, i, pvNode, isKiller,
+                                         isGoodCapture, historyScore);
+                if (reduction > 0) stats.lmrReductions++;
             }
             
-            // Unmake the move
-            board.unmakeMove(move, previousState);
+            // Try a null window search first
+            eval = -negamax<SearchNodeType::NON_PV>(board, newDepth - reduction, -alpha - 1, -alpha,
+                                                    childPV, ply + 1, move);
             
-            // Update the best move if this move is better
-            if (eval > maxEval) {
-                maxEval = eval;
-                localBestMove = move;
-                
-                // Update principal variation
-                pv.clear();
-                pv.push_back(move);
-                pv.insert(pv.end(), childPV.begin(), childPV.end());
-                
-                foundPV = true;
-            }
-            
-            // Alpha-beta pruning
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) {
-                // Store this move as a killer move if it's not a capture
-                if (!board.getPieceAt(move.to)) {
-                    // Update killer moves table
-                    storeKillerMove(move, ply);
-                    
-                    // Update history heuristic
-                    updateHistoryScore(move, depth, board.getSideToMove());
-                    
-                    // Store counter move if we have a previous move
-                    if (lastMove.from.isValid() && lastMove.to.isValid()) {
-                        storeCounterMove(lastMove, move);
-                    }
-                }
-                
-                nodeType = NodeType::BETA; // Fail high
-                break;
+            // The reduced search beat alpha - verify at full depth
+            if (reduction > 0 && eval > alpha) {
+                stats.lmrResearches++;
+                childPV.clear();
+                eval = -negamax<SearchNodeType::NON_PV>(board, newDepth, -alpha - 1, -alpha,
+                                                        childPV, ply + 1, move);
             }
         }
         
-        // Store result in transposition table
-        if (maxEval > originalAlpha && maxEval < beta) {
-            nodeType = NodeType::EXACT;
+        // In PV nodes, the first move and any move that lands inside the window
+        // get a full window search
+        if (pvNode && (i == 0 || (eval > alpha && eval < beta))) {
+            childPV.clear();
+            eval = -negamax<SearchNodeType::PV>(board, newDepth, -beta, -alpha, childPV, ply + 1, move);
         }
-        transpositionTable.store(hashKey, depth, maxEval, nodeType, localBestMove);
         
-        return maxEval;
-    } else {
-        // Minimizing player - similar code as above with appropriate modifications
-        int minEval = std::numeric_limits<int>::max();
+        // Unmake the move
+        positionKeys.pop_back();
+        board.unmakeMove(move, previousState);
         
-        for (size_t i = 0; i < scoredMoves.size(); i++) {
-            const Move& move = scoredMoves[i].second;
-            
-            // Additional move-specific extensions
-            int moveExtension = extension;
+        // Update the best move if this move is better
+        if (eval > bestScore) {
+            bestScore = eval;
+            localBestMove = move;
             
-            // 3. Recapture Extension - extend when recapturing at the same square
-            if (lastMove.to.isValid() && move.to == lastMove.to) {
-                moveExtension = std::max(moveExtension, 1);
-            }
+            // Update principal variation
+            pv.clear();
+            pv.push_back(move);
+            pv.insert(pv.end(), childPV.begin(), childPV.end());
+        }
+        
+        // Alpha-beta pruning
+        alpha = std::max(alpha, eval);
+        if (alpha >= beta) {
+            int bonus = historyBonus(depth);
+            stats.betaCutoffs++;
+            stats.cutoffsByMove[std::min(i, STATS_CUTOFF_BUCKETS - 1)]++;
             
-            // 4. Pawn Push Extension - extend when a pawn makes it to the 7th rank
-            auto piece = board.getPieceAt(move.from);
-            if (piece && piece->getType() == PieceType::PAWN) {
-                int destRow = (board.getSideToMove() == Color::WHITE) ? 6 : 1; // 7th rank
-                if (move.to.row == destRow) {
-                    moveExtension = std::max(moveExtension, 1);
+            // Store this move as a killer move if it's not a capture or promotion
+            if (!isTactical) {
+                // Update killer moves table
+                storeKillerMove(move, ply);
+                
+                // Update history and continuation history, with a malus for
+                // the quiet moves searched before this one
+                updateQuietHistory(board, move, ply, bonus);
+                for (const Move& quiet : quietsTried) {
+                    updateQuietHistory(board, quiet, ply, -bonus);
                 }
-            }
-            
-            // Save board state for unmaking move
-            BoardState previousState;
-            
-            // Make the move
-            if (!board.makeMove(move, previousState))
-                continue;
-            
-            // Calculate the new hash key after the move
-            uint64_t newHashKey = Zobrist::updateHashKey(hashKey, move, board);
-            
-            // Recursively evaluate the position with potential extension
-            childPV.clear();
-            int eval;
-            
-            // Full window search for first move, null window for others
-            if (foundPV) {
-                // Try a null window search first
-                eval = -pvSearch(board, depth - 1 + moveExtension, -alpha - 1, -alpha, true, childPV, newHashKey, ply + 1, move);
                 
-                // If we might fail high, do a full window search
-                if (eval > alpha && eval < beta) {
-                    childPV.clear();
-                    eval = -pvSearch(board, depth - 1 + moveExtension, -beta, -alpha, true, childPV, newHashKey, ply + 1, move);
+                // Store counter move if we have a previous move
+                if (lastMove.from.isValid() && lastMove.to.isValid()) {
+                    storeCounterMove(board, lastMove, move);
                 }
             } else {
-                // First move gets a full window search
-                eval = -pvSearch(board, depth - 1 + moveExtension, -beta, -alpha, true, childPV, newHashKey, ply + 1, move);
+                updateCaptureHistory(board, move, bonus);
             }
             
-            // Unmake the move
-            board.unmakeMove(move, previousState);
-            
-            // Update the best move if this move is better
-            if (eval < minEval) {
-                minEval = eval;
-                localBestMove = move;
-                
-                // Update principal variation
-                pv.clear();
-                pv.push_back(move);
-                pv.insert(pv.end(), childPV.begin(), childPV.end());
-                
-                foundPV = true;
+            // Captures searched before the cutoff move didn't refute this position
+            for (const Move& capture : capturesTried) {
+                updateCaptureHistory(board, capture, -bonus);
             }
             
-            // Alpha-beta pruning
-            beta = std::min(beta, eval);
-            if (beta <= alpha) {
-                // Store this move as a killer move if it's not a capture
-                if (!board.getPieceAt(move.to)) {
-                    // Update killer moves table
-                    storeKillerMove(move, ply);
-                    
-                    // Update history heuristic
-                    updateHistoryScore(move, depth, board.getSideToMove());
-                    
-                    // Store counter move if we have a previous move
-                    if (lastMove.from.isValid() && lastMove.to.isValid()) {
-                        storeCounterMove(lastMove, move);
-                    }
-                }
-                
-                nodeType = NodeType::ALPHA; // Fail low
-                break;
-            }
+            nodeType = NodeType::BETA; // Fail high
+            break;
         }
         
-        // Store result in transposition table
-        if (minEval > originalAlpha && minEval < beta) {
-            nodeType = NodeType::EXACT;
+        if (isTactical) {
+            capturesTried.push_back(move);
+        } else {
+            quietsTried.push_back(move);
         }
-        transpositionTable.store(hashKey, depth, minEval, nodeType, localBestMove);
-        
-        return minEval;
     }
-}
-
-// Regular alpha-beta search (kept for reference/fallback)
-int Engine::alphaBeta(Board& board, int depth, int alpha, int beta, bool maximizingPlayer, 
-                    std::vector<Move>& pv, uint64_t hashKey, int ply, Move lastMove) {
-    // Track nodes searched
-    nodesSearched++;
     
-    // Check transposition table for this position
-    int originalAlpha = alpha;
-    Move ttMove(Position(), Position());
-    int score;
-    
-    pv.clear();
-    
-    // Probe the transposition table
-    if (ply > 0 && transpositionTable.probe(hashKey, depth, alpha, beta, score, ttMove)) {
-        return score; // Return cached result if available (but don't use TT at root)
+    // No legal moves: checkmate (adjusted for distance to mate) or stalemate.
+    // Without the excluded move that only means no other move beat alpha.
+    if (moveCount == 0) {
+        if (excluded) {
+            return alpha;
+        }
+        return inCheck ? -MATE_SCORE + ply : 0;
     }
     
-    // If we've reached the maximum depth, use quiescence search
-    if (depth == 0) {
-        return quiescenceSearch(board, alpha, beta, hashKey, ply);
+    // Store result in transposition table
+    if (bestScore > originalAlpha && bestScore < beta) {
+        nodeType = NodeType::EXACT;
     }
-    // If we've reached the maximum depth, use quiescence search
-     if (depth == 0) {
-        return quiescenceSearch(board, alpha, beta, hashKey, ply);
+    // A root search without some moves must not replace the root entry
+    if (!rootNode || excludedRootMoves.empty()) {
+        transpositionTable.store(hashKey, depth, bestScore, nodeType, localBestMove, ply);
     }
     
-      // If we've reached the maximum depth, use quiescence search
-    if (depth == 0) {
-        return quiescenceSearch(board, alpha, beta, hashKey, ply);
+    return bestScore;
+}
+
+int Engine::evaluatePosition(const Board& board) {
+    // Positions are often evaluated again across iterations and transpositions
+    int cachedScore;
+    if (evalCache.probe(board.getHashKey(), cachedScore)) {
+        stats.evalCacheHits++;
+        return cachedScore;
     }
+    stats.evalCacheMisses++;
     
-    // If the game is over, return the evaluation
-    if (board.isCheckmate() || board.isStalemate()) {
-        return evaluatePosition(board);
+    // The network evaluation replaces the hand-written terms when loaded
+    if (NNUE::isLoaded()) {
+        int score = board.evaluateNNUE();
+        evalCache.store(board.getHashKey(), score);
+        return score;
     }
     
-    // Generate all legal moves
-    std::vector<Move> legalMoves = board.generateLegalMoves();
+    // Blend the incrementally updated midgame and endgame scores by game phase
+    int mgScore = board.getMgScore();
+    int egScore = board.getEgScore();
     
-    // If there are no legal moves, either checkmate or stalemate
-    if (legalMoves.empty()) {
-        if (board.isInCheck()) {
-            // Checkmate (worst possible score, adjusted for distance to mate)
-            return maximizingPlayer ? -100000 + ply : 100000 - ply;
-        } else {
-            // Stalemate
-            return 0;
-        }
+    // Pawn structure and king shelter, cached by pawn configuration
+    int pawnMg, pawnEg;
+    stats.pawnHashProbes++;
+    if (pawnHashTable.evaluate(board, pawnMg, pawnEg)) {
+        stats.pawnHashHits++;
     }
+    mgScore += pawnMg;
+    egScore += pawnEg;
     
-    // Score each move for ordering
-    std::vector<std::pair<int, Move>> scoredMoves;
-    for (const auto& move : legalMoves) {
-        int moveScore = getMoveScore(move, board, ttMove, principalVariation, ply, board.getSideToMove(), lastMove);
-        
-        // Early pruning of very bad captures
-        if (depth >= 3) {
-            auto capturedPiece = board.getPieceAt(move.to);
-            if (capturedPiece) {
-                int seeScore = seeCapture(board, move);
-                // If SEE indicates a very bad capture, don't even consider this move
-                if (seeScore < -PAWN_VALUE * 2) {
-                    continue;
-                }
-            }
-        }
-        
-        scoredMoves.push_back(std::make_pair(moveScore, move));
-    }
-    
-    // Sort moves by score (descending)
-    std::sort(scoredMoves.begin(), scoredMoves.end(), 
-              [](const std::pair<int, Move>& a, const std::pair<int, Move>& b) {
-                  return a.first > b.first;
-              });
+#ifdef USE_MOBILITY_EVAL
+    // Mobility, king zone attacks, rooks on open files and the bishop pair
+    int activityMg, activityEg;
+    Mobility::evaluate(board, activityMg, activityEg);
+    mgScore += activityMg;
+    egScore += activityEg;
+#endif
     
-    NodeType nodeType = NodeType::ALPHA;
-    Move localBestMove = legalMoves.empty() ? Move(Position(), Position()) : legalMoves[0];
-    
-    // This will be used to store the principal variation
-    std::vector<Move> childPV;
+    int phase = std::min(board.getGamePhase(), PSQT::MAX_PHASE);
+    int score = (mgScore * phase + egScore * (PSQT::MAX_PHASE - phase)) / PSQT::MAX_PHASE;
     
-    if (maximizingPlayer) {
-        int maxEval = std::numeric_limits<int>::min();
-        
-        for (const auto& scoredMove : scoredMoves) {
-            const Move& move = scoredMove.second;
-            
-            // Make a copy of the board
-            Board tempBoard = board;
-            
-            // Make the move
-            tempBoard.makeMove(move);
-            
-            // Calculate the new hash key after the move
-            uint64_t newHashKey = Zobrist::updateHashKey(hashKey, move, board);
-            
-            // Recursively evaluate the position
-            childPV.clear();
-            int eval = alphaBeta(tempBoard, depth - 1, alpha, beta, false, childPV, newHashKey, ply + 1, move);
-            
-            // Update the best move if this move is better
-            if (eval > maxEval) {
-                maxEval = eval;
-                localBestMove = move;
-                
-                // Update principal variation
-                pv.clear();
-                pv.push_back(move);
-                pv.insert(pv.end(), childPV.begin(), childPV.end());
-            }
-            
-            // Alpha-beta pruning
-            alpha = std::max(alpha, eval);
-            if (beta <= alpha) {
-                // Store this move as a killer move if it's not a capture
-                if (board.getPieceAt(move.to) == nullptr) {
-                    // Update killer moves table
-                    storeKillerMove(move, ply);
-                    
-                    // Update history heuristic
-                    updateHistoryScore(move, depth, board.getSideToMove());
-                    
-                    // Store counter move if we have a previous move
-                    if (lastMove.from.isValid() && lastMove.to.isValid()) {
-                        storeCounterMove(lastMove, move);
-                    }
-                }
-                
-                nodeType = NodeType::BETA; // Fail high
-                break;
-            }
-        }
-        
-        // Store result in transposition table
-        if (maxEval > originalAlpha && maxEval < beta) {
-            nodeType = NodeType::EXACT;
-        }
-        transpositionTable.store(hashKey, depth, maxEval, nodeType, localBestMove);
-        
-        return maxEval;
-    } else {
-        int minEval = std::numeric_limits<int>::max();
-        
-        for (const auto& scoredMove : scoredMoves) {
-            const Move& move = scoredMove.second;
-            
-            // Make a copy of the board
-            Board tempBoard = board;
-            
-            // Make the move
-            tempBoard.makeMove(move);
-            
-            // Calculate the new hash key after the move
-            uint64_t newHashKey = Zobrist::updateHashKey(hashKey, move, board);
-            
-            // Recursively evaluate the position
-            childPV.clear();
-            int eval = alphaBeta(tempBoard, depth - 1, alpha, beta, true, childPV, newHashKey, ply + 1, move);
-            
-            // Update the best move if this move is better
-            if (eval < minEval) {
-                minEval = eval;
-                localBestMove = move;
-                
-                // Update principal variation
-                pv.clear();
-                pv.push_back(move);
-                pv.insert(pv.end(), childPV.begin(), childPV.end());
-            }
-            
-            // Alpha-beta pruning
-            beta = std::min(beta, eval);
-            if (beta <= alpha) {
-                // Store this move as a killer move if it's not a capture
-                if (board.getPieceAt(move.to) == nullptr) {
-                    // Update killer moves table
-                    storeKillerMove(move, ply);
-                    
-                    // Update history heuristic
-                    updateHistoryScore(move, depth, board.getSideToMove());
-                    
-                    // Store counter move if we have a previous move
-                    if (lastMove.from.isValid() && lastMove.to.isValid()) {
-                        storeCounterMove(lastMove, move);
-                    }
-                }
-                
-                nodeType = NodeType::ALPHA; // Fail low
-                break;
-            }
-        }
-        
-        // Store result in transposition table
-        if (minEval > originalAlpha && minEval < beta) {
-            nodeType = NodeType::EXACT;
-        }
-        transpositionTable.store(hashKey, depth, minEval, nodeType, localBestMove);
-        
-        return minEval;
-    }
+    // Adjust the score based on the side to move
+    score = board.getSideToMove() == Color::WHITE ? score : -score;
+    evalCache.store(board.getHashKey(), score);
+    return score;
 }
 
-// Evaluation function
-int Engine::evaluatePosition(const Board& board) {
-    int whiteScore = 0;
-    int blackScore = 0;
-    bool isEndgamePhase = isEndgame(board);
-    
-    // Loop through all squares on the board
-    for (int row = 0; row < 8; row++) {
-        for (int col = 0; col < 8; col++) {
-            Position pos(row, col);
-            auto piece = board.getPieceAt(pos);
-            
-            if (!piece) continue;
-            
-            // Base piece value
-            int pieceValue = 0;
-            
-            // Positional value based on piece-square tables
-            int positionalValue = 0;
-            
-            // Calculate the index for the piece-square tables
-            int tableIndex = row * 8 + col;
-            
-            // Adjust the index for black pieces (mirror the board)
-            int blackTableIndex = (7 - row) * 8 + col;
-            
-            switch (piece->getType()) {
-                case PieceType::PAWN:
-                    pieceValue = PAWN_VALUE;
-                    positionalValue = pawnTable[piece->getColor() == Color::WHITE ? tableIndex : blackTableIndex];
-                    break;
-                    
-                case PieceType::KNIGHT:
-                    pieceValue = KNIGHT_VALUE;
-                    positionalValue = knightTable[piece->getColor() == Color::WHITE ? tableIndex : blackTableIndex];
-                    break;
-                    
-                case PieceType::BISHOP:
-                    pieceValue = BISHOP_VALUE;
-                    positionalValue = bishopTable[piece->getColor() == Color::WHITE ? tableIndex : blackTableIndex];
-                    break;
-                    
-                case PieceType::ROOK:
-                    pieceValue = ROOK_VALUE;
-                    positionalValue = rookTable[piece->getColor() == Color::WHITE ? tableIndex : blackTableIndex];
-                    break;
-                    
-                case PieceType::QUEEN:
-                    pieceValue = QUEEN_VALUE;
-                    positionalValue = queenTable[piece->getColor() == Color::WHITE ? tableIndex : blackTableIndex];
-                    break;
-                    
-                case PieceType::KING:
-                    pieceValue = KING_VALUE;
-                    if (isEndgamePhase) {
-                        positionalValue = kingEndGameTable[piece->getColor() == Color::WHITE ? tableIndex : blackTableIndex];
-                    } else {
-                        positionalValue = kingMiddleGameTable[piece->getColor() == Color::WHITE ? tableIndex : blackTableIndex];
-                    }
-                    break;
-                    
-                default:
-                    break;
-            }
-            
-            // Add the piece value and positional value to the appropriate side's score
-            if (piece->getColor() == Color::WHITE) {
-                whiteScore += pieceValue + positionalValue;
-            } else {
-                blackScore += pieceValue + positionalValue;
-            }
-        }
+// Format a score for output: centipawns, or "mate N" in moves (negative when getting mated)
+std::string Engine::formatScore(int score) const {
+    if (score >= MATE_SCORE - MAX_PLY) {
+        return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
     }
-    
-    // Check for checkmate and stalemate
-    if (board.isCheckmate()) {
-        if (board.getSideToMove() == Color::WHITE) {
-            // Black wins
-            return -100000;
-        } else {
-            // White wins
-            return 100000;
+    if (score <= -MATE_SCORE + MAX_PLY) {
+        return "mate -" + std::to_string((MATE_SCORE + score) / 2);
+    }
+    return std::to_string(score);
+}
+
+// Repetitions are only possible since the last capture, pawn move or null move.
+// A single repetition inside the search is scored as a draw: if repeating is
+// good for one side, it can repeat again.
+bool Engine::isRepetition(const Board& board) const {
+    int last = static_cast<int>(positionKeys.size()) - 1;
+    int stop = std::max(nullMoveKeyIndex, last - board.getHalfMoveClock());
+    
+    for (int i = last - 4; i >= stop; i -= 2) {
+        if (positionKeys[i] == board.getHashKey()) {
+            return true;
         }
-    } else if (board.isStalemate()) {
-        // Draw
-        return 0;
     }
-    
-    // Calculate the final score from white's perspective
-    int score = whiteScore - blackScore;
-    
-    // Adjust the score based on the side to move
-    return board.getSideToMove() == Color::WHITE ? score : -score;
+    return false;
 }
 
-bool Engine::isEndgame(const Board& board) const {
-    int pieceCount = 0;
-    bool whiteQueenPresent = false;
-    bool blackQueenPresent = false;
-    
-    // Count the number of pieces and check if queens are present
+// Check if a side has any pieces besides pawns and the king
+bool Engine::hasNonPawnMaterial(const Board& board, Color color) const {
     for (int row = 0; row < 8; row++) {
         for (int col = 0; col < 8; col++) {
             auto piece = board.getPieceAt(Position(row, col));
-            
-            if (piece && piece->getType() != PieceType::KING && piece->getType() != PieceType::PAWN) {
-                pieceCount++;
-                
-                if (piece->getType() == PieceType::QUEEN) {
-                    if (piece->getColor() == Color::WHITE) {
-                        whiteQueenPresent = true;
-                    } else {
-                        blackQueenPresent = true;
-                    }
-                }
+            if (piece && piece->getColor() == color &&
+                piece->getType() != PieceType::PAWN && piece->getType() != PieceType::KING) {
+                return true;
             }
         }
     }
-    
-    // Consider it an endgame if:
-    // 1. Both queens are missing, or
-    // 2. There are few minor pieces left
-    return (!whiteQueenPresent && !blackQueenPresent) || (pieceCount <= 6);
+    return false;
 }
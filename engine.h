@@ -5,17 +5,95 @@
 #include "game.h"
 #include "transposition.h"
 #include "zobrist.h"
+#include "book.h"
+#include "movepicker.h"
+#include "psqt.h"
+#include "pawns.h"
+#include "evalcache.h"
+#include "nnue.h"
+#include "mobility.h"
+#include "searchstats.h"
+#include <chrono>
 
 // Maximum search depth - adjust if needed
 #define MAX_PLY 64
-#define MAX_QSEARCH_DEPTH 8
+
+// Null-move pruning: minimum depth, and depth from which fail-highs are verified
+#define NULL_MOVE_MIN_DEPTH 2
+#define NULL_MOVE_VERIFY_DEPTH 6
+
+// Singular extensions: minimum depth, how much shallower the hash entry may be,
+// and the margin below the hash score per ply of depth
+#define SINGULAR_MIN_DEPTH 6
+#define SINGULAR_TT_DEPTH_MARGIN 3
+#define SINGULAR_MARGIN 2
+
+// Shallow-depth pruning: reverse futility (static null move) margin per ply,
+// futility margin per ply on top of a base, and late move count pruning depth
+#define RFP_MAX_DEPTH 6
+#define RFP_MARGIN 80
+#define FUTILITY_MAX_DEPTH 3
+#define FUTILITY_MARGIN_BASE 50
+#define FUTILITY_MARGIN 100
+#define LMP_MAX_DEPTH 4
+
+// Internal iterative reduction: minimum depth at which nodes without a hash
+// move are searched one ply shallower
+#define IIR_MIN_DEPTH 5
+
+// History tables: entries saturate at +-HISTORY_MAX, the bonus of one cutoff is
+// at most HISTORY_BONUS_MAX, and capture history is divided by
+// CAPTURE_HISTORY_DIVISOR before it is added to the MVV-LVA score
+#define HISTORY_MAX 16384
+#define HISTORY_BONUS_MAX 1536
+#define CAPTURE_HISTORY_DIVISOR 128
+
+// Late move reductions: minimum depth and move index, table width and the
+// history score worth one ply less reduction
+#define LMR_MIN_DEPTH 3
+#define LMR_MIN_MOVES 3
+#define LMR_MAX_MOVES 64
+#define LMR_HISTORY_DIVISOR 8192
+
+// Node types of the main search: the root, nodes searched with a full window
+// (principal variation) and nodes searched with a null window
+enum class SearchNodeType {
+    ROOT,
+    PV,
+    NON_PV
+};
+
+// One line of a multi-PV search: its score from the side to move's point of
+// view, the nodes spent on it in the last iteration, and the moves
+struct PVLine {
+    int score;
+    long nodes;
+    std::vector<Move> moves;
+};
 
 class Engine
 {
+    // The move picker orders moves with the engine's MVV-LVA, SEE, killer,
+    // counter move and history tables
+    friend class MovePicker;
+
 private:
     int maxDepth;
     Game &game;
     TranspositionTable transpositionTable;
+    PawnHashTable pawnHashTable;
+    EvalCache evalCache;
+
+    // Polyglot opening book (optional)
+    OpeningBook openingBook;
+
+    // Number of lines searched per iteration, and the first moves of the lines
+    // already found in the current iteration (skipped at the root)
+    int multiPV;
+    std::vector<Move> excludedRootMoves;
+
+    // Lines of the last completed iteration, best first
+    std::vector<PVLine> multiPVLines;
 
     // Principal Variation (PV) storage
     std::vector<Move> principalVariation;
@@ -25,27 +103,63 @@ private:
     Move killerMoves[MAX_PLY][2];
 
     // Counter move heuristic table [piece_type][color][from_square][to_square]
-    // Stores moves that were effective against specific opponent moves
-    Move counterMoves[6][2][64][64];
+    // Stores moves that were effective against specific opponent moves.
+    // This and the continuation history are about 1 MB each, so they live
+    // on the heap to keep Engine small enough for the stack.
+    std::unique_ptr<Move[][2][64][64]> counterMoves;
 
     // History heuristic table [color][from_square][to_square]
     // Records how often moves lead to beta cutoffs
     int historyTable[2][64][64];
 
-    // Search statistics
-    long nodesSearched;
+    // Continuation history [previous piece and to_square][piece and to_square],
+    // shared by the moves one and two plies back. Pieces are indexed as
+    // color * 6 + type (see pieceSquareIndex).
+    std::unique_ptr<int16_t[][12 * 64]> continuationHistory;
+
+    // Capture history [piece][to_square][captured_type]
+    std::unique_ptr<int16_t[][64][6]> captureHistory;
+
+    // Piece and to-square of the move made at each ply of the current search
+    // path (-1 for a null move), for the continuation history
+    int movedPieceSquares[MAX_PLY];
+
+    // Percentage of the history tables kept from one search to the next
+    int historyAgingPercent;
+
+    // Search statistics, owned by this search (no sharing between threads)
+    SearchStats stats;
+
+    // File that gets one JSON line of statistics per search (empty = none)
+    std::string statsFile;
+
+    // Shallow-depth pruning switches, to measure each technique on its own
+    bool reverseFutilityEnabled;
+    bool futilityEnabled;
+    bool lateMovePruningEnabled;
+
+    // Static evaluation of the nodes on the current search path, by ply
+    // (NO_SCORE when in check); used to tell whether the position is improving
+    int staticEvals[MAX_PLY];
     std::chrono::time_point<std::chrono::high_resolution_clock> searchStartTime;
 
 public:
 Engine(Game &g, int depth = 3, int ttSizeMB = 64, bool useTimeManagement = false)
-    : game(g), maxDepth(depth), transpositionTable(ttSizeMB), nodesSearched(0),
+    : game(g), maxDepth(depth), transpositionTable(ttSizeMB),
+      multiPV(1), counterMoves(std::make_unique<Move[][2][64][64]>(6)),
+      continuationHistory(std::make_unique<int16_t[][12 * 64]>(12 * 64)),
+      captureHistory(std::make_unique<int16_t[][64][6]>(12)), historyAgingPercent(50),
+      reverseFutilityEnabled(true), futilityEnabled(true), lateMovePruningEnabled(true),
       timeAllocated(0), timeBuffer(100), timeManaged(useTimeManagement),
-      positionIsUnstable(false), unstableExtensionPercent(50)
+      nullMoveMinPly(0), nullMoveColor(Color::NONE),
+      positionIsUnstable(false), unstableExtensionPercent(50), nullMoveKeyIndex(0)
 {
     // Initialize tables
+    std::fill(std::begin(movedPieceSquares), std::end(movedPieceSquares), -1);
     clearKillerMoves();
     clearHistoryTable();
     clearCounterMoves();
+    initReductions();
 }
 
 public:
@@ -61,12 +175,55 @@ public:
     // Set transposition table size
     void setTTSize(int sizeMB) { transpositionTable.resize(sizeMB); }
 
+    // Set the evaluation cache size in MB
+    void setEvalCacheSize(int sizeMB) { evalCache.resize(sizeMB); }
+
+    // Evaluate with the neural network from the given file; false if it can't be loaded
+    bool loadEvalFile(const std::string &path)
+    {
+        if (!NNUE::load(path))
+            return false;
+        evalCache.clear();
+        return true;
+    }
+
+    // Go back to the piece-square evaluation
+    void useClassicalEval()
+    {
+        NNUE::unload();
+        evalCache.clear();
+    }
+
+    // Turn the shallow-depth pruning techniques on or off
+    void setReverseFutilityPruning(bool enabled) { reverseFutilityEnabled = enabled; }
+    void setFutilityPruning(bool enabled) { futilityEnabled = enabled; }
+    void setLateMovePruning(bool enabled) { lateMovePruningEnabled = enabled; }
+
+    // Percentage of the history scores kept at the start of each search
+    // (0 clears the tables, 100 keeps them unchanged)
+    void setHistoryAging(int percent) { historyAgingPercent = std::max(0, std::min(100, percent)); }
+
+    // Search the best n moves, each with its own score and PV
+    void setMultiPV(int n) { multiPV = std::max(1, n); }
+
     // Calculate the best move for the current position
     Move getBestMove();
 
+    // Lines found by the last search (one unless multi-PV is set)
+    const std::vector<PVLine> &getMultiPVLines() const { return multiPVLines; }
+
     // Clear the transposition table
     void clearTT() { transpositionTable.clear(); }
 
+    // Search a fixed set of positions to a fixed depth and report nodes, time and NPS
+    void runBench(int depth);
+
+    // Load a Polyglot opening book; book moves are played without searching
+    bool loadBook(const std::string &path) { return openingBook.open(path); }
+
+    // Stop using the opening book
+    void closeBook() { openingBook.close(); }
+
     // Clear the killer moves
     void clearKillerMoves()
     {
@@ -110,16 +267,25 @@ public:
                 }
             }
         }
+        std::fill_n(&continuationHistory[0][0], 12 * 64 * 12 * 64, 0);
+        std::fill_n(&captureHistory[0][0][0], 12 * 64 * 6, 0);
     }
 
     // Get the principal variation as a string
     std::string getPVString() const;
 
     // Get the number of nodes searched
-    long getNodesSearched() const { return nodesSearched; }
+    long getNodesSearched() const { return stats.nodes; }
+
+    // All counters of the last search
+    const SearchStats &getSearchStats() const { return stats; }
+
+    // Append the statistics of every search to a file as one JSON object per
+    // line; an empty path stops it
+    void setStatsFile(const std::string &path) { statsFile = path; }
 
     // Reset search statistics
-    void resetStats() { nodesSearched = 0; }
+    void resetStats() { stats.reset(); }
 
 private:
     // Time management variables
@@ -127,225 +293,56 @@ private:
     int timeBuffer;    // safety buffer to avoid timeout
     bool timeManaged;  // whether to use time management
 
+private:
+    // Null moves are disabled for nullMoveColor below nullMoveMinPly while a
+    // null-move fail-high is being verified
+    int nullMoveMinPly;
+    Color nullMoveColor;
+
 private:
     // Search instability detection
     bool positionIsUnstable;
     int unstableExtensionPercent; // Additional percentage of time for unstable positions
 
-    private:
-    int getDepthAdjustment(const Move& move, const Board& board, bool isPVMove, int moveIndex) const;
-
-// In engine.h, add these member variables
 private:
-    // PV following enhancements
-    std::vector<std::vector<Move>> pvTable; // Stores PV for each depth
-    
-// Initialize in the constructor
-Engine::Engine(...) {
-    
-    // Initialize PV table
-    pvTable.resize(MAX_PLY);
-    for (int i = 0; i < MAX_PLY; i++) {
-        pvTable[i].clear();
-    }
-}
-
-// Add a function to store the PV at a specific depth
-void Engine::storePV(int depth, const std::vector<Move>& pv) {
-    pvTable[depth] = pv;
-}
-
-// Modify isPVMove to use the PV table
-bool Engine::isPVMove(const Move& move, int depth, int ply) const {
-    if (depth < 0 || depth >= MAX_PLY || ply >= pvTable[depth].size()) {
-        return false;
-    }
-    
-    const Move& pvMove = pvTable[depth][ply];
-    return (pvMove.from.row == move.from.row && 
-            pvMove.from.col == move.from.col && 
-            pvMove.to.row == move.to.row && 
-            pvMove.to.col == move.to.col);
-}
+    // Late move reduction table indexed by [depth][moveIndex]
+    int reductions[MAX_PLY][LMR_MAX_MOVES];
+    void initReductions();
 
+    // Reduction for a quiet move or losing capture, called after the move is made.
+    // historyScore is the quiet history score of the move (0 for captures).
+    int getReduction(const Board& board, int depth, int moveIndex, bool isPVNode,
+                     bool isKiller, bool isGoodCapture, int historyScore) const;
 
 private:
     // Iterative deepening search
-    Move Engine::iterativeDeepeningSearch(Board& board, int maxDepth, uint64_t hashKey) {
-    principalVariation.clear();
-    Move bestMove(Position(), Position());
-    Move previousBestMove(Position(), Position());
-    int bestScore = 0;
-    int previousScore = 0;
-    
-    // For time management
-    long nodesPrevious = 0;
-    long nodesTotal = 0;
-    
-    // For aspiration windows
-    int windowSize = 50;
-    
-    // For instability detection
-    int bestMoveChanges = 0;
-    int scoreSwings = 0;
-    bool isUnstable = false;
-    
-    // Iterative deepening loop
-    for (int depth = 1; depth <= maxDepth; depth++) {
-        std::vector<Move> pv;
-        
-        // Record nodes before this iteration
-        nodesPrevious = nodesSearched;
-        
-        // Store previous iteration's results
-        previousBestMove = bestMove;
-        previousScore = bestScore;
-        
-        // Color is set to true for maximizing player (WHITE), false for minimizing player (BLACK)
-        bool maximizingPlayer = board.getSideToMove() == Color::WHITE;
-        
-        int alpha, beta, delta = windowSize;
-        int score;
-        
-        // For depth 1, use full window
-        if (depth == 1) {
-            alpha = -100000;
-            beta = 100000;
-            score = pvSearch(board, depth, alpha, beta, maximizingPlayer, pv, hashKey, 0, Move(Position(), Position()));
-        } 
-        else {
-            // Use aspiration windows for deeper searches
-            alpha = bestScore - delta;
-            beta = bestScore + delta;
-            
-            // Try with narrow window first
-            while (true) {
-                score = pvSearch(board, depth, alpha, beta, maximizingPlayer, pv, hashKey, 0, Move(Position(), Position()));
-                
-                // If the score falls within our window, we're good
-                if (score > alpha && score < beta) {
-                    break;
-                }
-                
-                // If we failed low (score <= alpha), widen the window
-                if (score <= alpha) {
-                    alpha = std::max(-100000, alpha - delta);
-                    delta *= 2; // Increase window size
-                    std::cout << "Aspiration fail low. New alpha: " << alpha << std::endl;
-                } 
-                // If we failed high (score >= beta), widen the window
-                else if (score >= beta) {
-                    beta = std::min(100000, beta + delta);
-                    delta *= 2; // Increase window size
-                    std::cout << "Aspiration fail high. New beta: " << beta << std::endl;
-                }
-                
-                // If window is already full, break
-                if (alpha <= -99000 && beta >= 99000) {
-                    break;
-                }
-            }
-        }
-        
-        // Store the best move and score if we got valid results
-        if (!pv.empty()) {
-            bestMove = pv[0];
-            bestScore = score;
-            principalVariation = pv;
-        }
-        
-        // Instability detection
-        if (depth >= 2) {
-            // Check if best move changed
-            if (bestMove.from.row != previousBestMove.from.row || 
-                bestMove.from.col != previousBestMove.from.col || 
-                bestMove.to.row != previousBestMove.to.row || 
-                bestMove.to.col != previousBestMove.to.col) {
-                bestMoveChanges++;
-                std::cout << "Best move changed from " << previousBestMove.toString() 
-                          << " to " << bestMove.toString() << std::endl;
-            }
-            
-            // Check for significant evaluation swings
-            const int SCORE_SWING_THRESHOLD = 50; // Centipawns
-            if (std::abs(bestScore - previousScore) > SCORE_SWING_THRESHOLD) {
-                scoreSwings++;
-                std::cout << "Score swing detected: " << previousScore 
-                          << " -> " << bestScore << std::endl;
-            }
-            
-            // Determine if position is unstable
-            isUnstable = (bestMoveChanges >= 2 || scoreSwings >= 1) && depth >= 3;
-            
-            if (isUnstable && !positionIsUnstable) {
-                std::cout << "Position detected as unstable. Allocating more time." << std::endl;
-                positionIsUnstable = true;
-            }
-        }
-        
-        // Log the progress
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - searchStartTime);
-        
-        // Nodes for this iteration
-        long nodesThisIteration = nodesSearched - nodesPrevious;
-        nodesTotal = nodesSearched;
-        
-        std::cout << "Depth: " << depth 
-                  << ", Score: " << score 
-                  << ", Nodes: " << nodesSearched 
-                  << ", Time: " << duration.count() << "ms" 
-                  << ", NPS: " << static_cast<long>(nodesSearched * 1000.0 / duration.count())
-                  << ", PV: " << getPVString() << std::endl;
-        
-        // Time management check
-        if (timeManaged && timeAllocated > 0) {
-            // Check if we should start next iteration
-            int timeUsed = duration.count();
-            
-            // Calculate adjusted time allocation based on position stability
-            int adjustedTimeAllocation = timeAllocated;
-            if (positionIsUnstable) {
-                adjustedTimeAllocation += (timeAllocated * unstableExtensionPercent) / 100;
-                std::cout << "Extending time allocation to " << adjustedTimeAllocation 
-                          << "ms due to position instability" << std::endl;
-            }
-            
-            // Estimate time for next iteration: typically 4-5x more nodes required
-            long estimatedNodesNext = nodesThisIteration * 4.5;
-            double estimatedTimeNext = (double)timeUsed * estimatedNodesNext / nodesThisIteration;
-            
-            // If we estimate we'll exceed our adjusted time allocation for the next iteration, stop now
-            if (timeUsed + estimatedTimeNext + timeBuffer > adjustedTimeAllocation) {
-                std::cout << "Stopping search due to time constraints. Time used: " 
-                          << timeUsed << "ms, Estimated for next: " 
-                          << estimatedTimeNext << "ms" << std::endl;
-                break;
-            }
-        }
-    }
-    
-    return bestMove;
-}
+    Move iterativeDeepeningSearch(Board& board, int maxDepth);
 
-    // Alpha-beta minimax search algorithm with transposition table
-    int alphaBeta(Board &board, int depth, int alpha, int beta, bool maximizingPlayer,
-                  std::vector<Move> &pv, uint64_t hashKey, int ply, Move lastMove);
+    // Root search with an aspiration window around the previous iteration's
+    // score, widened until the score falls inside it
+    int aspirationSearch(Board& board, int depth, int previousScore, std::vector<Move>& pv);
 
-    // Principal Variation Search (PVS) - optimization of alpha-beta
-    int pvSearch(Board &board, int depth, int alpha, int beta, bool maximizingPlayer,
-                 std::vector<Move> &pv, uint64_t hashKey, int ply, Move lastMove);
+    // Negamax principal variation search with transposition table. Scores are
+    // relative to the side to move; the node type is fixed at compile time.
+    // A valid excludedMove searches the position without that move (singular
+    // extension verification).
+    template <SearchNodeType searchNode>
+    int negamax(Board &board, int depth, int alpha, int beta,
+                std::vector<Move> &pv, int ply, Move lastMove, Move excludedMove = Move());
 
     // Quiescence search for handling captures at leaf nodes
     int quiescenceSearch(Board &board, int alpha, int beta, uint64_t hashKey, int ply);
     // Static Exchange Evaluation (SEE)
     int seeCapture(const Board &board, const Move &move) const;
-    int see(const Board &board, const Position &square, Color side, int capture_value) const;
+
+    // Check if the SEE value of a move is at least the threshold (early exit, for pruning)
+    bool seeGE(const Board &board, const Move &move, int threshold) const;
 
     // Get the approximate value of a piece for SEE
     int getPieceValue(PieceType type) const;
 
-    // Evaluate a board position
+    // Static evaluation from the side to move's point of view. Checkmate and
+    // stalemate are not detected here; the search scores them when no legal move exists.
     int evaluatePosition(const Board &board);
 
     // MVV-LVA (Most Valuable Victim - Least Valuable Aggressor) scoring
@@ -357,35 +354,41 @@ private:
     // Check if a move is a killer move at the current ply
     bool isKillerMove(const Move &move, int ply) const;
 
-    // Store a counter move
-    void storeCounterMove(const Move &lastMove, const Move &counterMove);
+    // Store a counter move; board is the position the counter move is played in
+    void storeCounterMove(const Board &board, const Move &lastMove, const Move &counterMove);
+
+    // Get counter move for an opponent's move; board is the position after it
+    Move getCounterMove(const Board &board, const Move &lastMove) const;
 
-    // Get counter move for an opponent's move
-    Move getCounterMove(const Move &lastMove) const;
+    // Index of a piece moving to a square in the continuation history
+    static int pieceSquareIndex(const Piece &piece, const Position &to);
 
-    // Update history heuristic table for a move that caused beta cutoff
-    void updateHistoryScore(const Move &move, int depth, Color color);
+    // History bonus for a cutoff at the given depth
+    static int historyBonus(int depth);
+
+    // Add a bonus (or a malus, if negative) to the history and continuation
+    // history of a quiet move about to be played on board at ply
+    void updateQuietHistory(const Board &board, const Move &move, int ply, int bonus);
+
+    // Add a bonus (or a malus, if negative) to the capture history of a capture
+    void updateCaptureHistory(const Board &board, const Move &move, int bonus);
+
+    // Scale the history tables by historyAgingPercent, so scores from earlier
+    // searches in the game carry over without outweighing new ones
+    void ageHistoryTables();
 
     // Get the history score for a move
     int getHistoryScore(const Move &move, Color color) const;
 
-    // Get score for move ordering
-    int getMoveScore(const Move &move, const Board &board, const Move &ttMove,
-                     const std::vector<Move> &pv, int ply, Color sideToMove,
-                     const Move &lastMove) const;
+    // History plus continuation history of a quiet move about to be played on board at ply
+    int getQuietHistoryScore(const Board &board, const Move &move, int ply) const;
+
+    // Capture history of a capture about to be played on board
+    int getCaptureHistoryScore(const Board &board, const Move &move) const;
 
     // Check if a move is part of the principal variation
     bool isPVMove(const Move &move, const std::vector<Move> &pv, int ply) const;
 
-    // Piece value tables for positional evaluation
-    static const int pawnTable[64];
-    static const int knightTable[64];
-    static const int bishopTable[64];
-    static const int rookTable[64];
-    static const int queenTable[64];
-    static const int kingMiddleGameTable[64];
-    static const int kingEndGameTable[64];
-
     // Piece values
     static const int PAWN_VALUE = 100;
     static const int KNIGHT_VALUE = 320;
@@ -394,8 +397,30 @@ private:
     static const int QUEEN_VALUE = 900;
     static const int KING_VALUE = 20000;
 
-    // Check if the game is in the endgame phase
-    bool isEndgame(const Board &board) const;
+    // Marks a missing static evaluation (in check); below any real score
+    static const int NO_SCORE = -MATE_SCORE - 1;
+
+    // Check if a side has pieces other than pawns and the king (null-move zugzwang guard)
+    bool hasNonPawnMaterial(const Board &board, Color color) const;
+
+    // Zobrist keys of the game so far followed by the current search path
+    std::vector<uint64_t> positionKeys;
+
+    // Index in positionKeys of the position after the last null move (0 if none);
+    // positions before a null move can't be repeated
+    int nullMoveKeyIndex;
+
+    // Check if the current position repeats an earlier one with the same side to move
+    bool isRepetition(const Board &board) const;
+
+    // Score as printed in the search log: centipawns or "mate N"
+    std::string formatScore(int score) const;
+
+    // Append the statistics of the last search to statsFile, if one is set
+    void writeStatsFile() const;
+
+    // Moves of a line separated by spaces
+    static std::string formatPV(const std::vector<Move> &pv);
 };
 
 #endif // ENGINE_H
\ No newline at end of file
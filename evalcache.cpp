@@ -0,0 +1,22 @@
+#include "evalcache.h"
+
+EvalCache::EvalCache(int sizeMB) : mask(0) {
+    resize(sizeMB);
+}
+
+void EvalCache::resize(int sizeMB) {
+    size_t numEntries = (static_cast<size_t>(sizeMB) * 1024 * 1024) / sizeof(EvalCacheEntry);
+    
+    // Power of 2 entries so the index is a mask of the key
+    size_t size = 1;
+    while (size * 2 <= numEntries) {
+        size *= 2;
+    }
+    
+    table.assign(size, EvalCacheEntry());
+    mask = size - 1;
+}
+
+void EvalCache::clear() {
+    std::fill(table.begin(), table.end(), EvalCacheEntry());
+}
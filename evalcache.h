@@ -0,0 +1,50 @@
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include "main.h"
+
+// Entry of the evaluation cache
+struct EvalCacheEntry {
+    uint64_t key;  // Zobrist hash key of the position
+    int score;     // Static evaluation from the side to move's point of view
+    
+    EvalCacheEntry() : key(0), score(0) {}
+};
+
+// Small lossy cache of static evaluations, indexed by the position hash.
+// Newer entries always overwrite older ones. The cache belongs to a single
+// search, so it needs no locking.
+class EvalCache {
+private:
+    std::vector<EvalCacheEntry> table;
+    size_t mask;
+    
+public:
+    // Constructor with table size in MB
+    EvalCache(int sizeMB = 1);
+    
+    // Resize the table (rounded down to a power of 2 entries)
+    void resize(int sizeMB);
+    
+    // Look up a position. Returns true and sets score on a hit.
+    bool probe(uint64_t key, int& score) {
+        const EvalCacheEntry& entry = table[key & mask];
+        if (entry.key == key) {
+            score = entry.score;
+            return true;
+        }
+        return false;
+    }
+    
+    // Store the evaluation of a position
+    void store(uint64_t key, int score) {
+        EvalCacheEntry& entry = table[key & mask];
+        entry.key = key;
+        entry.score = score;
+    }
+    
+    // Clear the table
+    void clear();
+};
+
+#endif // EVALCACHE_H
@@ -1,6 +1,4 @@
 #include "game.h"
-#include <map>
-#include <sstream>
 #include <algorithm>
 
 Game::Game() {
@@ -10,8 +8,9 @@ Game::Game() {
 void Game::newGame() {
     board.setupStartingPosition();
     moveHistory.clear();
-    fenHistory.clear();
-    fenHistory.push_back(board.toFEN());
+    undoHistory.clear();
+    keyHistory.assign(1, board.getHashKey());
+    startFEN = board.toFEN();
     result = GameResult::IN_PROGRESS;
     endReason = GameEndReason::NONE;
 }
@@ -19,8 +18,9 @@ void Game::newGame() {
 void Game::newGameFromFEN(const std::string& fen) {
     board.setupFromFEN(fen);
     moveHistory.clear();
-    fenHistory.clear();
-    fenHistory.push_back(fen);
+    undoHistory.clear();
+    keyHistory.assign(1, board.getHashKey());
+    startFEN = fen;
     result = GameResult::IN_PROGRESS;
     endReason = GameEndReason::NONE;
 }
@@ -30,19 +30,16 @@ bool Game::makeMove(const Move& move) {
         return false;
     }
     
-    // Store the current FEN position before making the move
-    std::string currentFEN = board.toFEN();
-    
-    // Try to make the move
-    if (!board.makeMove(move)) {
+    // Try to make the move, keeping what's needed to take it back
+    BoardState undo;
+    if (!board.makeMove(move, undo)) {
         return false;
     }
     
-    // Add the move to the history
+    // Add the move, its undo record and the new position's key to the history
     moveHistory.push_back(move);
-    
-    // Add the new position to the FEN history
-    fenHistory.push_back(board.toFEN());
+    undoHistory.push_back(undo);
+    keyHistory.push_back(board.getHashKey());
     
     // Check for end-of-game conditions
     if (board.isCheckmate()) {
@@ -102,14 +99,13 @@ bool Game::undoMove() {
         return false;
     }
     
-    // Remove the last move from the history
-    moveHistory.pop_back();
-    
-    // Remove the last position from the FEN history
-    fenHistory.pop_back();
+    // Take the last move back on the board
+    board.unmakeMove(moveHistory.back(), undoHistory.back());
     
-    // Restore the board to the previous position
-    board.setupFromFEN(fenHistory.back());
+    // Remove it from the history
+    moveHistory.pop_back();
+    undoHistory.pop_back();
+    keyHistory.pop_back();
     
     // Reset the game result
     result = GameResult::IN_PROGRESS;
@@ -118,6 +114,19 @@ bool Game::undoMove() {
     return true;
 }
 
+std::vector<std::string> Game::getFENHistory() const {
+    Board replay;
+    replay.setupFromFEN(startFEN);
+    
+    std::vector<std::string> fens;
+    fens.push_back(startFEN);
+    for (const Move& move : moveHistory) {
+        replay.makeMove(move);
+        fens.push_back(replay.toFEN());
+    }
+    return fens;
+}
+
 bool Game::isInsufficientMaterial() const {
     int whiteBishops = 0;
     int whiteKnights = 0;
@@ -200,38 +209,20 @@ bool Game::isInsufficientMaterial() const {
 }
 
 bool Game::isFiftyMoveRule() const {
-    // Extract the halfmove clock from the current FEN
-    std::string fen = board.toFEN();
-    std::istringstream ss(fen);
-    std::string board, activeColor, castling, enPassant, halfmove, fullmove;
-    
-    ss >> board >> activeColor >> castling >> enPassant >> halfmove >> fullmove;
-    
-    int halfMoveClock = std::stoi(halfmove);
-    
     // The fifty-move rule applies when the halfmove clock reaches 100 (50 moves by each player)
-    return halfMoveClock >= 100;
+    return board.getHalfMoveClock() >= 100;
 }
 
 bool Game::isThreefoldRepetition() const {
-    // Count the occurrences of each position
-    std::map<std::string, int> positionCount;
+    // Only positions with the same side to move since the last capture or pawn
+    // move can repeat the current one
+    uint64_t key = keyHistory.back();
+    int last = static_cast<int>(keyHistory.size()) - 1;
+    int stop = std::max(0, last - board.getHalfMoveClock());
+    int count = 1;
     
-    for (const auto& fen : fenHistory) {
-        // Extract the position part of the FEN (ignore the half move clock and full move number)
-        std::istringstream ss(fen);
-        std::string position, activeColor, castling, enPassant, halfmove, fullmove;
-        
-        ss >> position >> activeColor >> castling >> enPassant;
-        
-        // Combine the relevant parts of the FEN
-        std::string relevantPart = position + " " + activeColor + " " + castling + " " + enPassant;
-        
-        // Increment the count for this position
-        positionCount[relevantPart]++;
-        
-        // If this position has occurred three times, return true
-        if (positionCount[relevantPart] >= 3) {
+    for (int i = last - 2; i >= stop; i -= 2) {
+        if (keyHistory[i] == key && ++count >= 3) {
             return true;
         }
     }
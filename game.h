@@ -25,7 +25,9 @@ class Game {
 private:
     Board board;
     std::vector<Move> moveHistory;
-    std::vector<std::string> fenHistory;
+    std::vector<BoardState> undoHistory; // State needed to unmake each move in moveHistory
+    std::vector<uint64_t> keyHistory; // Zobrist keys of every position, current last
+    std::string startFEN;             // Position the game started from
     GameResult result;
     GameEndReason endReason;
     
@@ -59,8 +61,14 @@ public:
     // Get the move history
     const std::vector<Move>& getMoveHistory() const { return moveHistory; }
     
-    // Get the FEN history
-    const std::vector<std::string>& getFENHistory() const { return fenHistory; }
+    // Get the FEN of the current position
+    std::string getFEN() const { return board.toFEN(); }
+    
+    // Get the FEN of every position so far, rebuilt by replaying the moves
+    std::vector<std::string> getFENHistory() const;
+    
+    // Get the Zobrist keys of the positions so far (the current position last)
+    const std::vector<uint64_t>& getKeyHistory() const { return keyHistory; }
     
     // Check for draw by insufficient material
     bool isInsufficientMaterial() const;
@@ -0,0 +1,39 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "main.h"
+
+// Read-only memory mapping of a file on disk.
+// Used for large binary data (opening books) so lookups touch
+// only the pages they need instead of loading the whole file.
+class MappedFile {
+private:
+    const uint8_t* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Map the given file, replacing any previous mapping
+    bool open(const std::string& path);
+    
+    // Release the mapping
+    void close();
+    
+    // Check if a file is currently mapped
+    bool isOpen() const { return data != nullptr; }
+    
+    // Access the mapped bytes
+    const uint8_t* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+#endif // MAPPED_FILE_H
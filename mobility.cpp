@@ -0,0 +1,128 @@
+#include "mobility.h"
+#include "attacks.h"
+#include "board.h"
+
+const int Mobility::mobilityWeight[4][3] = {
+    { 4, 4, 4 },
+    { 5, 5, 7 },
+    { 2, 4, 7 },
+    { 1, 2, 14 }
+};
+
+const int Mobility::kingAttackWeight[4] = { 2, 2, 3, 5 };
+
+const int Mobility::attackerScale[8] = { 0, 0, 50, 75, 88, 94, 97, 99 };
+
+const int Mobility::rookOpenFile[2] = { 20, 10 };
+const int Mobility::rookSemiOpenFile[2] = { 10, 5 };
+
+const int Mobility::bishopPair[2] = { 30, 50 };
+
+void Mobility::evaluate(const Board& board, int& mgScore, int& egScore, MobilityTrace* trace) {
+    // Bitboards by [color][piece type] and by color
+    uint64_t pieces[2][6] = {};
+    uint64_t occupied[2] = { 0, 0 };
+    int kingSquare[2] = { -1, -1 };
+    
+    for (int sq = 0; sq < 64; sq++) {
+        auto piece = board.getPieceAt(Position(sq / 8, sq % 8));
+        if (!piece) continue;
+        
+        int c = piece->getColor() == Color::WHITE ? 0 : 1;
+        pieces[c][static_cast<int>(piece->getType())] |= 1ULL << sq;
+        occupied[c] |= 1ULL << sq;
+        if (piece->getType() == PieceType::KING) kingSquare[c] = sq;
+    }
+    uint64_t all = occupied[0] | occupied[1];
+    
+    // Squares attacked by pawns, and the ring around each king
+    uint64_t pawnAttacks[2] = { 0, 0 };
+    uint64_t kingZone[2] = { 0, 0 };
+    for (int c = 0; c < 2; c++) {
+        for (uint64_t b = pieces[c][static_cast<int>(PieceType::PAWN)]; b; b &= b - 1) {
+            pawnAttacks[c] |= Attacks::pawn(c, Attacks::lsb(b));
+        }
+        if (kingSquare[c] >= 0) {
+            kingZone[c] = Attacks::king(kingSquare[c]) | (1ULL << kingSquare[c]);
+        }
+    }
+    
+    int mg[2] = { 0, 0 };
+    int eg[2] = { 0, 0 };
+    
+    for (int c = 0; c < 2; c++) {
+        int them = 1 - c;
+        int sign = c == 0 ? 1 : -1;
+        
+        // Squares not occupied by own pieces and not controlled by enemy pawns
+        uint64_t mobilityArea = ~occupied[c] & ~pawnAttacks[them];
+        int attackers = 0;
+        int attackWeight = 0;
+        int zoneAttackCount[4] = { 0, 0, 0, 0 };
+        
+        for (int t = 0; t < 4; t++) {
+            PieceType type = static_cast<PieceType>(static_cast<int>(PieceType::KNIGHT) + t);
+            
+            for (uint64_t b = pieces[c][static_cast<int>(type)]; b; b &= b - 1) {
+                int sq = Attacks::lsb(b);
+                uint64_t attacks;
+                switch (type) {
+                    case PieceType::KNIGHT: attacks = Attacks::knight(sq); break;
+                    case PieceType::BISHOP: attacks = Attacks::bishop(sq, all); break;
+                    case PieceType::ROOK: attacks = Attacks::rook(sq, all); break;
+                    default: attacks = Attacks::queen(sq, all); break;
+                }
+                
+                int moves = Attacks::popCount(attacks & mobilityArea) - mobilityWeight[t][2];
+                mg[c] += mobilityWeight[t][0] * moves;
+                eg[c] += mobilityWeight[t][1] * moves;
+                if (trace) {
+                    trace->mobility[t][0] += sign * moves;
+                    trace->mobility[t][1] += sign * moves;
+                }
+                
+                uint64_t zoneAttacks = attacks & kingZone[them];
+                if (zoneAttacks) {
+                    attackers++;
+                    attackWeight += kingAttackWeight[t] * Attacks::popCount(zoneAttacks);
+                    zoneAttackCount[t] += Attacks::popCount(zoneAttacks);
+                }
+                
+                if (type == PieceType::ROOK) {
+                    uint64_t file = Attacks::fileMask(sq % 8);
+                    if (!(file & pieces[c][static_cast<int>(PieceType::PAWN)])) {
+                        bool open = !(file & pieces[them][static_cast<int>(PieceType::PAWN)]);
+                        mg[c] += open ? rookOpenFile[0] : rookSemiOpenFile[0];
+                        eg[c] += open ? rookOpenFile[1] : rookSemiOpenFile[1];
+                        if (trace) {
+                            int* counts = open ? trace->rookOpenFile : trace->rookSemiOpenFile;
+                            counts[0] += sign;
+                            counts[1] += sign;
+                        }
+                    }
+                }
+            }
+        }
+        
+        // A lone attacker is rarely dangerous; several together are
+        int scale = attackerScale[std::min(attackers, 7)];
+        mg[c] += attackWeight * 10 * scale / 100;
+        if (trace) {
+            for (int t = 0; t < 4; t++) {
+                trace->kingAttack[t] += sign * zoneAttackCount[t] * 10 * scale / 100.0;
+            }
+        }
+        
+        if (Attacks::popCount(pieces[c][static_cast<int>(PieceType::BISHOP)]) >= 2) {
+            mg[c] += bishopPair[0];
+            eg[c] += bishopPair[1];
+            if (trace) {
+                trace->bishopPair[0] += sign;
+                trace->bishopPair[1] += sign;
+            }
+        }
+    }
+    
+    mgScore = mg[0] - mg[1];
+    egScore = eg[0] - eg[1];
+}
@@ -0,0 +1,51 @@
+#ifndef MOBILITY_H
+#define MOBILITY_H
+
+#include "main.h"
+
+class Board;
+
+// How many times each activity weight applies to a position, white minus
+// black. The tuner fits the weights from these counts.
+struct MobilityTrace {
+    int mobility[4][2];      // Squares above the baseline by piece type {midgame, endgame}
+    double kingAttack[4];    // King zone attacks by piece type, scaled by attacker count (midgame)
+    int rookOpenFile[2];
+    int rookSemiOpenFile[2];
+    int bishopPair[2];
+    
+    MobilityTrace() : mobility{}, kingAttack{}, rookOpenFile{}, rookSemiOpenFile{}, bishopPair{} {}
+};
+
+// Piece activity terms: mobility, attacks on the enemy king zone, rooks on
+// open files and the bishop pair. All of them come from one pass over the
+// pieces that builds each piece's attack set once from bitboards.
+class Mobility {
+    // The tuner reads the weights it starts from
+    friend class Tuner;
+    
+private:
+    // Mobility bonus per reachable square, relative to a typical square count,
+    // indexed by piece type (knight, bishop, rook, queen): {midgame, endgame, baseline}
+    static const int mobilityWeight[4][3];
+    
+    // Weight of an attack on a king zone square by piece type (knight, bishop, rook, queen)
+    static const int kingAttackWeight[4];
+    
+    // Scale (percent) of the king attack weight by number of attackers
+    static const int attackerScale[8];
+    
+    // Rook on a file without pawns, or without own pawns: {midgame, endgame}
+    static const int rookOpenFile[2];
+    static const int rookSemiOpenFile[2];
+    
+    // Two or more bishops: {midgame, endgame}
+    static const int bishopPair[2];
+    
+public:
+    // Activity scores (white - black) for the position, counting the weights
+    // used in trace if given
+    static void evaluate(const Board& board, int& mgScore, int& egScore, MobilityTrace* trace = nullptr);
+};
+
+#endif // MOBILITY_H
@@ -0,0 +1,182 @@
+#include "movepicker.h"
+#include "board.h"
+#include "engine.h"
+
+MovePicker::MovePicker(const Board& board, const Engine& engine, const Move& ttMove, int ply, const Move& lastMove)
+    : board(board), engine(engine), ttMove(ttMove), ply(ply), quiescence(false), evasions(false),
+      includeBadCaptures(true), stage(PickerStage::TT_MOVE), current(0) {
+    if (ply < MAX_PLY) {
+        killers[0] = engine.killerMoves[ply][0];
+        killers[1] = engine.killerMoves[ply][1];
+    }
+    counterMove = engine.getCounterMove(board, lastMove);
+}
+
+MovePicker::MovePicker(const Board& board, const Engine& engine, const Move& ttMove)
+    : board(board), engine(engine), ttMove(ttMove), ply(0), quiescence(false), evasions(true),
+      includeBadCaptures(true), stage(PickerStage::TT_MOVE), current(0) {}
+
+MovePicker::MovePicker(const Board& board, const Engine& engine, const Move& ttMove, bool includeBadCaptures)
+    : board(board), engine(engine), ttMove(ttMove), ply(0), quiescence(true), evasions(false),
+      includeBadCaptures(includeBadCaptures), stage(PickerStage::TT_MOVE), current(0) {}
+
+bool MovePicker::isTactical(const Move& move) const {
+    if (!move.from.isValid() || !move.to.isValid()) return false;
+    
+    auto piece = board.getPieceAt(move.from);
+    if (!piece || piece->getColor() != board.getSideToMove()) return false;
+    
+    auto target = board.getPieceAt(move.to);
+    if (target) return target->getColor() != piece->getColor();
+    
+    return board.isTactical(move);
+}
+
+bool MovePicker::isUsableQuiet(const Move& move) const {
+    if (!move.from.isValid() || !move.to.isValid() || move == ttMove) return false;
+    
+    // The board validates the move when it is made, so only reject moves that
+    // would also be returned by the capture stages
+    auto piece = board.getPieceAt(move.from);
+    return piece && piece->getColor() == board.getSideToMove() && !isTactical(move);
+}
+
+bool MovePicker::isSpecialMove(const Move& move) const {
+    return move == ttMove ||
+           (isUsableQuiet(killers[0]) && move == killers[0]) ||
+           (isUsableQuiet(killers[1]) && move == killers[1]) ||
+           (isUsableQuiet(counterMove) && move == counterMove);
+}
+
+bool MovePicker::selectBest(Move& move) {
+    if (current >= moves.size()) return false;
+    
+    size_t best = current;
+    for (size_t i = current + 1; i < moves.size(); i++) {
+        if (moves[i].first > moves[best].first) {
+            best = i;
+        }
+    }
+    std::swap(moves[current], moves[best]);
+    move = moves[current++].second;
+    return true;
+}
+
+bool MovePicker::next(Move& move) {
+    switch (stage) {
+        case PickerStage::TT_MOVE:
+            stage = PickerStage::GENERATE_CAPTURES;
+            // The board validates the move when it is made, so a hash collision is harmless
+            if (quiescence ? isTactical(ttMove) : ttMove.from.isValid() && ttMove.to.isValid()) {
+                move = ttMove;
+                return true;
+            }
+            // Fall through
+            
+        case PickerStage::GENERATE_CAPTURES: {
+            auto captures = board.generateCaptureMoves();
+            moves.reserve(captures.size());
+            
+            for (const auto& m : captures) {
+                if (m == ttMove) {
+                    continue;
+                }
+                
+                // MVV-LVA, with a promotion worth the value of the new piece.
+                // The capture history orders captures of the same victim.
+                auto movingPiece = board.getPieceAt(m.from);
+                auto capturedPiece = board.getPieceAt(m.to);
+                int score = engine.getMVVLVAScore(movingPiece->getType(),
+                                                  capturedPiece ? capturedPiece->getType() : PieceType::PAWN);
+                if (m.promotion != PieceType::NONE) {
+                    score += engine.getPieceValue(m.promotion);
+                }
+                score += engine.getCaptureHistoryScore(board, m) / CAPTURE_HISTORY_DIVISOR;
+                moves.emplace_back(score, m);
+            }
+            
+            stage = PickerStage::GOOD_CAPTURES;
+        }
+            // Fall through
+            
+        case PickerStage::GOOD_CAPTURES:
+            while (selectBest(move)) {
+                // SEE is only computed for moves that are actually reached
+                bool underpromotion = move.promotion != PieceType::NONE && move.promotion != PieceType::QUEEN;
+                if (underpromotion || !engine.seeGE(board, move, 0)) {
+                    badCaptures.push_back(move);
+                    continue;
+                }
+                return true;
+            }
+            
+            stage = quiescence ? PickerStage::BAD_CAPTURES : PickerStage::KILLER_1;
+            current = 0;
+            return next(move);
+            
+        case PickerStage::KILLER_1:
+            stage = PickerStage::KILLER_2;
+            if (isUsableQuiet(killers[0])) {
+                move = killers[0];
+                return true;
+            }
+            // Fall through
+            
+        case PickerStage::KILLER_2:
+            stage = PickerStage::COUNTER_MOVE;
+            if (isUsableQuiet(killers[1]) && killers[1] != killers[0]) {
+                move = killers[1];
+                return true;
+            }
+            // Fall through
+            
+        case PickerStage::COUNTER_MOVE:
+            stage = PickerStage::GENERATE_QUIETS;
+            if (isUsableQuiet(counterMove) && counterMove != killers[0] &&
+                counterMove != killers[1]) {
+                move = counterMove;
+                return true;
+            }
+            // Fall through
+            
+        case PickerStage::GENERATE_QUIETS: {
+            auto quiets = board.generateQuietMoves();
+            moves.clear();
+            moves.reserve(quiets.size());
+            
+            for (const auto& m : quiets) {
+                if (!isSpecialMove(m)) {
+                    int score = evasions ? engine.getHistoryScore(m, board.getSideToMove())
+                                         : engine.getQuietHistoryScore(board, m, ply);
+                    moves.emplace_back(score, m);
+                }
+            }
+            
+            stage = PickerStage::QUIETS;
+        }
+            // Fall through
+            
+        case PickerStage::QUIETS:
+            if (selectBest(move)) {
+                return true;
+            }
+            
+            stage = PickerStage::BAD_CAPTURES;
+            current = 0;
+            // Fall through
+            
+        case PickerStage::BAD_CAPTURES:
+            if (includeBadCaptures && current < badCaptures.size()) {
+                move = badCaptures[current++];
+                return true;
+            }
+            
+            stage = PickerStage::DONE;
+            // Fall through
+            
+        case PickerStage::DONE:
+            break;
+    }
+    
+    return false;
+}
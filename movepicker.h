@@ -0,0 +1,76 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "main.h"
+#include "piece.h"
+
+class Board;
+class Engine;
+
+// Stages of the move picker, in the order they are visited
+enum class PickerStage {
+    TT_MOVE,            // Hash move, tried before any generation
+    GENERATE_CAPTURES,  // Generate captures and promotions
+    GOOD_CAPTURES,      // Captures that don't lose material, best MVV-LVA first
+    KILLER_1,           // First killer move of this ply
+    KILLER_2,           // Second killer move of this ply
+    COUNTER_MOVE,       // Refutation of the opponent's last move
+    GENERATE_QUIETS,    // Generate the remaining quiet moves
+    QUIETS,             // Quiet moves, best history plus continuation history first
+    BAD_CAPTURES,       // Losing captures and underpromotions
+    DONE
+};
+
+// Staged move picker for the main search and quiescence search. Moves are
+// generated only when the previous stage is exhausted and selected one at a
+// time, so a cutoff skips the remaining generation and sorting work.
+class MovePicker {
+private:
+    const Board& board;
+    const Engine& engine;
+    Move ttMove;
+    Move killers[2];
+    Move counterMove;
+    int ply;
+    bool quiescence;
+    bool evasions;
+    bool includeBadCaptures;
+    PickerStage stage;
+    
+    // Scored moves of the current stage and the next one to select
+    std::vector<std::pair<int, Move>> moves;
+    std::vector<Move> badCaptures;
+    size_t current;
+    
+    // Check if a move is a capture or promotion of the side to move
+    bool isTactical(const Move& move) const;
+    
+    // Check if a killer or counter move can be tried as a quiet move here
+    bool isUsableQuiet(const Move& move) const;
+    
+    // Check if a move was already returned by the TT, killer or counter move stage
+    bool isSpecialMove(const Move& move) const;
+    
+    // Move the best scored move from the current position to the front and return it
+    bool selectBest(Move& move);
+    
+public:
+    // Main search: all moves, with killers and the counter move before other quiets
+    MovePicker(const Board& board, const Engine& engine, const Move& ttMove, int ply, const Move& lastMove);
+    
+    // Quiescence search in check: all evasions, with quiet moves ordered by the
+    // butterfly history alone since quiescence keeps no killers or counter moves
+    MovePicker(const Board& board, const Engine& engine, const Move& ttMove);
+    
+    // Quiescence search: captures and promotions only.
+    // Bad captures are only returned when includeBadCaptures is set.
+    MovePicker(const Board& board, const Engine& engine, const Move& ttMove, bool includeBadCaptures);
+    
+    // Get the next move to search. Returns false when no moves are left.
+    bool next(Move& move);
+    
+    // Current stage of the picker
+    PickerStage getStage() const { return stage; }
+};
+
+#endif // MOVEPICKER_H
@@ -0,0 +1,258 @@
+#include "nnue.h"
+#include "board.h"
+#include <fstream>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
+std::vector<int16_t> NNUE::ftBiases;
+std::vector<int16_t> NNUE::ftWeights;
+std::vector<int32_t> NNUE::l1Biases;
+std::vector<int8_t> NNUE::l1Weights;
+std::vector<int32_t> NNUE::l2Biases;
+std::vector<int8_t> NNUE::l2Weights;
+int32_t NNUE::outBias = 0;
+std::vector<int8_t> NNUE::outWeights;
+bool NNUE::loaded = false;
+unsigned NNUE::generation = 0;
+
+namespace {
+
+// Quantization: hidden layer outputs are shifted down by 2^6 and clipped to
+// [0, 127]; the final output is divided by 16 to get centipawns.
+constexpr int WEIGHT_SCALE_BITS = 6;
+constexpr int OUTPUT_SCALE = 16;
+
+// Little-endian readers that work regardless of the host byte order
+bool readU32(std::istream& in, uint32_t& value) {
+    unsigned char bytes[4];
+    if (!in.read(reinterpret_cast<char*>(bytes), 4)) return false;
+    value = uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) |
+            (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+    return true;
+}
+
+bool readI16(std::istream& in, std::vector<int16_t>& values, size_t count) {
+    std::vector<unsigned char> bytes(count * 2);
+    if (!in.read(reinterpret_cast<char*>(bytes.data()), bytes.size())) return false;
+    values.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        values[i] = int16_t(uint16_t(bytes[2 * i]) | (uint16_t(bytes[2 * i + 1]) << 8));
+    }
+    return true;
+}
+
+bool readI32(std::istream& in, std::vector<int32_t>& values, size_t count) {
+    values.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t value;
+        if (!readU32(in, value)) return false;
+        values[i] = int32_t(value);
+    }
+    return true;
+}
+
+bool readI8(std::istream& in, std::vector<int8_t>& values, size_t count) {
+    values.resize(count);
+    return bool(in.read(reinterpret_cast<char*>(values.data()), count));
+}
+
+// acc += column (or -= for sign < 0), NNUE_L1 values
+void addColumn(int16_t* acc, const int16_t* column, int sign) {
+#if defined(__AVX2__)
+    for (int i = 0; i < NNUE_L1; i += 16) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        a = sign > 0 ? _mm256_add_epi16(a, w) : _mm256_sub_epi16(a, w);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), a);
+    }
+#elif defined(__SSE4_1__)
+    for (int i = 0; i < NNUE_L1; i += 8) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        a = sign > 0 ? _mm_add_epi16(a, w) : _mm_sub_epi16(a, w);
+        _mm_store_si128(reinterpret_cast<__m128i*>(acc + i), a);
+    }
+#else
+    for (int i = 0; i < NNUE_L1; i++) {
+        acc[i] = int16_t(acc[i] + sign * column[i]);
+    }
+#endif
+}
+
+// Dot product of unsigned 8-bit inputs (0..127) with signed 8-bit weights.
+// size must be a multiple of 32.
+int32_t dot(const uint8_t* input, const int8_t* weights, int size) {
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < size; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+        // Inputs are at most 127, so the pairwise int16 sums cannot saturate
+        __m256i products = _mm256_maddubs_epi16(in, w);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0x4E));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0xB1));
+    return _mm_cvtsi128_si32(sum128);
+#elif defined(__SSE4_1__)
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < size; i += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+        __m128i products = _mm_maddubs_epi16(in, w);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < size; i++) {
+        sum += int32_t(input[i]) * int32_t(weights[i]);
+    }
+    return sum;
+#endif
+}
+
+// Dense layer followed by the clipped ReLU
+void affineClipped(const uint8_t* input, int inSize, const int8_t* weights,
+                   const int32_t* biases, uint8_t* output, int outSize) {
+    for (int o = 0; o < outSize; o++) {
+        int32_t value = (biases[o] + dot(input, weights + o * inSize, inSize)) >> WEIGHT_SCALE_BITS;
+        output[o] = uint8_t(std::max(0, std::min(127, int(value))));
+    }
+}
+
+} // namespace
+
+int NNUE::featureIndex(Color perspective, const Position& kingPos,
+                       PieceType type, Color color, const Position& pos) {
+    // Each perspective sees the board from its own side
+    int kingSquare = perspective == Color::WHITE ? kingPos.row * 8 + kingPos.col
+                                                 : (7 - kingPos.row) * 8 + kingPos.col;
+    int square = perspective == Color::WHITE ? pos.row * 8 + pos.col
+                                             : (7 - pos.row) * 8 + pos.col;
+    int piece = static_cast<int>(type) * 2 + (color == perspective ? 0 : 1);
+    return kingSquare * 641 + piece * 64 + square + 1;
+}
+
+void NNUE::refresh(const Board& board, NNUEAccumulator& acc, Color perspective) {
+    int side = static_cast<int>(perspective);
+    std::copy(ftBiases.begin(), ftBiases.end(), acc.values[side]);
+    Position kingPos = board.getKingPosition(perspective);
+    if (!kingPos.isValid()) return;
+
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            Position pos(row, col);
+            auto piece = board.getPieceAt(pos);
+            if (!piece || piece->getType() == PieceType::KING) continue;
+            int feature = featureIndex(perspective, kingPos, piece->getType(), piece->getColor(), pos);
+            addColumn(acc.values[side], &ftWeights[size_t(feature) * NNUE_L1], 1);
+        }
+    }
+    acc.computed[side] = true;
+}
+
+bool NNUE::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint32_t version, features, l1, l2, l3;
+    if (!in.read(magic, 4) || std::string(magic, 4) != "CENN") return false;
+    if (!readU32(in, version) || version != FILE_VERSION) return false;
+    if (!readU32(in, features) || !readU32(in, l1) || !readU32(in, l2) || !readU32(in, l3)) return false;
+    if (features != NNUE_FEATURES || l1 != NNUE_L1 || l2 != NNUE_L2 || l3 != NNUE_L3) return false;
+
+    // Read into temporaries so a broken file leaves the current network intact
+    std::vector<int16_t> newFtBiases, newFtWeights;
+    std::vector<int32_t> newL1Biases, newL2Biases, newOutBias;
+    std::vector<int8_t> newL1Weights, newL2Weights, newOutWeights;
+    if (!readI16(in, newFtBiases, NNUE_L1) ||
+        !readI16(in, newFtWeights, size_t(NNUE_FEATURES) * NNUE_L1) ||
+        !readI32(in, newL1Biases, NNUE_L2) ||
+        !readI8(in, newL1Weights, size_t(NNUE_L2) * 2 * NNUE_L1) ||
+        !readI32(in, newL2Biases, NNUE_L3) ||
+        !readI8(in, newL2Weights, size_t(NNUE_L3) * NNUE_L2) ||
+        !readI32(in, newOutBias, 1) ||
+        !readI8(in, newOutWeights, NNUE_L3)) {
+        return false;
+    }
+
+    ftBiases = std::move(newFtBiases);
+    ftWeights = std::move(newFtWeights);
+    l1Biases = std::move(newL1Biases);
+    l1Weights = std::move(newL1Weights);
+    l2Biases = std::move(newL2Biases);
+    l2Weights = std::move(newL2Weights);
+    outBias = newOutBias[0];
+    outWeights = std::move(newOutWeights);
+    loaded = true;
+
+    // Accumulators built for the previous network are now stale
+    generation++;
+    return true;
+}
+
+void NNUE::unload() {
+    loaded = false;
+    generation++;
+}
+
+void NNUE::updatePiece(const Board& board, NNUEAccumulator& acc,
+                       const Piece& piece, const Position& pos, int sign) {
+    if (acc.generation != generation) return;
+
+    for (Color perspective : {Color::WHITE, Color::BLACK}) {
+        int side = static_cast<int>(perspective);
+        if (!acc.computed[side]) continue;
+
+        // Moving a king changes every feature of its own perspective
+        Position kingPos = board.getKingPosition(perspective);
+        if ((piece.getType() == PieceType::KING && piece.getColor() == perspective) || !kingPos.isValid()) {
+            acc.computed[side] = false;
+            continue;
+        }
+        if (piece.getType() == PieceType::KING) continue;
+
+        int feature = featureIndex(perspective, kingPos, piece.getType(), piece.getColor(), pos);
+        addColumn(acc.values[side], &ftWeights[size_t(feature) * NNUE_L1], sign);
+    }
+}
+
+int NNUE::evaluate(const Board& board, NNUEAccumulator& acc) {
+    if (acc.generation != generation) {
+        acc.computed[0] = acc.computed[1] = false;
+        acc.generation = generation;
+    }
+    for (Color perspective : {Color::WHITE, Color::BLACK}) {
+        if (!acc.computed[static_cast<int>(perspective)]) {
+            refresh(board, acc, perspective);
+        }
+    }
+
+    // Side to move first, then the opponent, clipped to [0, 127]
+    alignas(32) uint8_t input[2 * NNUE_L1];
+    int us = static_cast<int>(board.getSideToMove());
+    for (int half = 0; half < 2; half++) {
+        const int16_t* values = acc.values[half == 0 ? us : 1 - us];
+        for (int i = 0; i < NNUE_L1; i++) {
+            input[half * NNUE_L1 + i] = uint8_t(std::max(0, std::min(127, int(values[i]))));
+        }
+    }
+
+    alignas(32) uint8_t hidden1[NNUE_L2];
+    alignas(32) uint8_t hidden2[NNUE_L3];
+    affineClipped(input, 2 * NNUE_L1, l1Weights.data(), l1Biases.data(), hidden1, NNUE_L2);
+    affineClipped(hidden1, NNUE_L2, l2Weights.data(), l2Biases.data(), hidden2, NNUE_L3);
+
+    return (outBias + dot(hidden2, outWeights.data(), NNUE_L3)) / OUTPUT_SCALE;
+}
@@ -0,0 +1,101 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "main.h"
+#include "piece.h"
+
+class Board;
+
+// Network dimensions: HalfKP features (own king square x non-king piece
+// square) feed a 256-wide accumulator per perspective, followed by two
+// 32-wide hidden layers and a single output.
+constexpr int NNUE_FEATURES = 64 * 641;
+constexpr int NNUE_L1 = 256;
+constexpr int NNUE_L2 = 32;
+constexpr int NNUE_L3 = 32;
+
+// First layer output for both perspectives (white = 0, black = 1). Owned
+// by the board and updated by setPieceAt; a perspective whose king moved is
+// rebuilt from scratch when the position is next evaluated.
+struct NNUEAccumulator {
+    alignas(32) int16_t values[2][NNUE_L1];
+    bool computed[2];
+    unsigned generation; // Network the values were computed for
+
+    NNUEAccumulator() : computed{false, false}, generation(0) {}
+};
+
+// A board's accumulator, allocated the first time the board is evaluated by
+// the network. Copies start without one, so the boards copied for legality
+// checks don't carry the accumulator around.
+class NNUEAccumulatorPtr {
+private:
+    std::unique_ptr<NNUEAccumulator> acc;
+
+public:
+    NNUEAccumulatorPtr() = default;
+    NNUEAccumulatorPtr(const NNUEAccumulatorPtr&) {}
+    NNUEAccumulatorPtr& operator=(const NNUEAccumulatorPtr&) { acc.reset(); return *this; }
+    NNUEAccumulatorPtr(NNUEAccumulatorPtr&&) = default;
+    NNUEAccumulatorPtr& operator=(NNUEAccumulatorPtr&&) = default;
+
+    // Accumulator to update, or nullptr if the board was never evaluated
+    NNUEAccumulator* get() const { return acc.get(); }
+
+    // Accumulator to evaluate with, allocated on first use
+    NNUEAccumulator& getOrCreate()
+    {
+        if (!acc) acc = std::make_unique<NNUEAccumulator>();
+        return *acc;
+    }
+};
+
+// Efficiently updatable neural network evaluation. The network is shared
+// by all boards and is optional; without one the engine uses the
+// piece-square evaluation.
+//
+// File format (little-endian): magic "CENN", uint32 version, uint32
+// feature count and layer sizes, then the int16 feature transformer biases
+// and weights, and for each dense layer its int32 biases followed by int8
+// weights (row-major, one row per output).
+class NNUE {
+private:
+    static std::vector<int16_t> ftBiases;
+    static std::vector<int16_t> ftWeights;
+    static std::vector<int32_t> l1Biases;
+    static std::vector<int8_t> l1Weights;
+    static std::vector<int32_t> l2Biases;
+    static std::vector<int8_t> l2Weights;
+    static int32_t outBias;
+    static std::vector<int8_t> outWeights;
+    static bool loaded;
+    static unsigned generation;
+
+    // Feature index of a non-king piece seen from the given perspective
+    static int featureIndex(Color perspective, const Position& kingPos,
+                            PieceType type, Color color, const Position& pos);
+
+    // Recompute one perspective of the accumulator from the board
+    static void refresh(const Board& board, NNUEAccumulator& acc, Color perspective);
+
+public:
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    // Load a network file; the previous network is kept if loading fails
+    static bool load(const std::string& path);
+
+    // Drop the network and go back to the piece-square evaluation
+    static void unload();
+
+    // Check if a network is loaded
+    static bool isLoaded() { return loaded; }
+
+    // Add (sign = 1) or remove (sign = -1) a piece from the accumulator
+    static void updatePiece(const Board& board, NNUEAccumulator& acc,
+                            const Piece& piece, const Position& pos, int sign);
+
+    // Evaluate the board from the side to move's point of view
+    static int evaluate(const Board& board, NNUEAccumulator& acc);
+};
+
+#endif // NNUE_H
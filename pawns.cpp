@@ -0,0 +1,208 @@
+#include "pawns.h"
+#include "board.h"
+
+const int PawnHashTable::doubledPenalty[2] = { 10, 20 };
+const int PawnHashTable::isolatedPenalty[2] = { 10, 15 };
+const int PawnHashTable::backwardPenalty[2] = { 8, 10 };
+
+const int PawnHashTable::passedBonusMg[8] = { 0, 5, 10, 15, 25, 40, 60, 0 };
+const int PawnHashTable::passedBonusEg[8] = { 0, 10, 20, 35, 60, 100, 150, 0 };
+
+const int PawnHashTable::shieldBonus[4] = { -15, 10, 5, 0 };
+const int PawnHashTable::stormPenalty[5] = { 0, 5, 15, 10, 5 };
+
+PawnHashTable::PawnHashTable(size_t entries) {
+    size_t size = 1;
+    while (size * 2 <= entries) size *= 2;
+    table.resize(size);
+    mask = size - 1;
+}
+
+void PawnHashTable::clear() {
+    std::fill(table.begin(), table.end(), PawnEntry());
+}
+
+void PawnHashTable::evaluateStructure(const Board& board, PawnEntry& entry, PawnTrace* trace) {
+    bool pawns[2][8][8] = {}; // [color][row][col]
+    
+    for (int c = 0; c < 2; c++) {
+        for (int f = 0; f < 8; f++) {
+            entry.fileCount[c][f] = 0;
+            entry.pawnRows[c][f] = 0;
+        }
+    }
+    
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            auto piece = board.getPieceAt(Position(row, col));
+            if (!piece || piece->getType() != PieceType::PAWN) continue;
+            
+            int c = piece->getColor() == Color::WHITE ? 0 : 1;
+            pawns[c][row][col] = true;
+            entry.fileCount[c][col]++;
+            entry.pawnRows[c][col] |= 1 << row;
+        }
+    }
+    
+    int mg[2] = { 0, 0 };
+    int eg[2] = { 0, 0 };
+    
+    for (int c = 0; c < 2; c++) {
+        int them = 1 - c;
+        int forward = c == 0 ? 1 : -1;
+        int sign = c == 0 ? 1 : -1;
+        
+        for (int col = 0; col < 8; col++) {
+            // Doubled: every extra pawn on the file
+            if (entry.fileCount[c][col] > 1) {
+                int extra = entry.fileCount[c][col] - 1;
+                mg[c] -= doubledPenalty[0] * extra;
+                eg[c] -= doubledPenalty[1] * extra;
+                if (trace) {
+                    trace->doubled[0] -= sign * extra;
+                    trace->doubled[1] -= sign * extra;
+                }
+            }
+        }
+        
+        for (int row = 1; row < 7; row++) {
+            for (int col = 0; col < 8; col++) {
+                if (!pawns[c][row][col]) continue;
+                
+                int relativeRank = c == 0 ? row : 7 - row;
+                bool hasLeft = col > 0 && entry.fileCount[c][col - 1] > 0;
+                bool hasRight = col < 7 && entry.fileCount[c][col + 1] > 0;
+                
+                // Passed: no enemy pawn ahead on this or an adjacent file
+                bool passed = true;
+                for (int r = row + forward; r >= 0 && r < 8 && passed; r += forward) {
+                    for (int f = std::max(0, col - 1); f <= std::min(7, col + 1); f++) {
+                        if (pawns[them][r][f]) passed = false;
+                    }
+                }
+                if (passed) {
+                    mg[c] += passedBonusMg[relativeRank];
+                    eg[c] += passedBonusEg[relativeRank];
+                    if (trace) {
+                        trace->passedMg[relativeRank] += sign;
+                        trace->passedEg[relativeRank] += sign;
+                    }
+                }
+                
+                // Isolated: no friendly pawn on an adjacent file
+                if (!hasLeft && !hasRight) {
+                    mg[c] -= isolatedPenalty[0];
+                    eg[c] -= isolatedPenalty[1];
+                    if (trace) {
+                        trace->isolated[0] -= sign;
+                        trace->isolated[1] -= sign;
+                    }
+                    continue;
+                }
+                
+                // Backward: no adjacent friendly pawn level or behind, and the
+                // stop square is controlled by an enemy pawn
+                bool supported = false;
+                for (int r = row; r >= 0 && r < 8 && !supported; r -= forward) {
+                    if ((col > 0 && pawns[c][r][col - 1]) || (col < 7 && pawns[c][r][col + 1])) {
+                        supported = true;
+                    }
+                }
+                int stopRow = row + forward;
+                int attackRow = stopRow + forward;
+                bool stopAttacked = attackRow >= 0 && attackRow < 8 &&
+                                    ((col > 0 && pawns[them][attackRow][col - 1]) ||
+                                     (col < 7 && pawns[them][attackRow][col + 1]));
+                if (!supported && stopAttacked) {
+                    mg[c] -= backwardPenalty[0];
+                    eg[c] -= backwardPenalty[1];
+                    if (trace) {
+                        trace->backward[0] -= sign;
+                        trace->backward[1] -= sign;
+                    }
+                }
+            }
+        }
+    }
+    
+    entry.mgScore = mg[0] - mg[1];
+    entry.egScore = eg[0] - eg[1];
+}
+
+// Row of the pawn closest in front of a king on kingRow, up the board for a
+// white king and down for a black one (-1 if there is none)
+static int nearestPawnInFront(uint8_t pawnRows, int c, int kingRow) {
+    int step = c == 0 ? 1 : -1;
+    for (int row = kingRow + step; row >= 0 && row < 8; row += step) {
+        if (pawnRows & (1 << row)) return row;
+    }
+    return -1;
+}
+
+int PawnHashTable::evaluateShelter(const PawnEntry& entry, Color color, const Position& kingPos,
+                                   PawnTrace* trace) {
+    int c = color == Color::WHITE ? 0 : 1;
+    int them = 1 - c;
+    int sign = c == 0 ? 1 : -1;
+    int score = 0;
+    
+    for (int f = std::max(0, kingPos.col - 1); f <= std::min(7, kingPos.col + 1); f++) {
+        // Own pawn closest in front of the king; pawns behind it don't shield
+        int ownRow = nearestPawnInFront(entry.pawnRows[c][f], c, kingPos.row);
+        int ownDistance = ownRow < 0 ? 0 : std::abs(ownRow - kingPos.row);
+        int shieldIndex = ownDistance < 4 ? ownDistance : 0;
+        score += shieldBonus[shieldIndex];
+        if (trace) trace->shield[shieldIndex] += sign;
+        
+        // Enemy pawn closest in front of the king is the one storming the file
+        int theirRow = nearestPawnInFront(entry.pawnRows[them][f], c, kingPos.row);
+        if (theirRow >= 0) {
+            int stormDistance = std::abs(theirRow - kingPos.row);
+            if (stormDistance < 5) {
+                score -= stormPenalty[stormDistance];
+                if (trace) trace->storm[stormDistance] -= sign;
+            }
+        }
+    }
+    
+    return score;
+}
+
+bool PawnHashTable::evaluate(const Board& board, int& mgScore, int& egScore) {
+    uint64_t key = board.getPawnKey();
+    PawnEntry& entry = table[key & mask];
+    
+    bool hit = entry.key == key;
+    if (!hit) {
+        entry.key = key;
+        evaluateStructure(board, entry);
+        entry.kingSquare[0] = entry.kingSquare[1] = -1;
+    }
+    
+    // King shelter is cached for the last king square of each side
+    for (int c = 0; c < 2; c++) {
+        Position kingPos = board.getKingPosition(c == 0 ? Color::WHITE : Color::BLACK);
+        int square = kingPos.isValid() ? kingPos.row * 8 + kingPos.col : 64;
+        if (entry.kingSquare[c] != square) {
+            entry.kingSquare[c] = square;
+            entry.shelter[c] = kingPos.isValid() ? evaluateShelter(entry, c == 0 ? Color::WHITE : Color::BLACK, kingPos) : 0;
+        }
+    }
+    
+    mgScore = entry.mgScore + entry.shelter[0] - entry.shelter[1];
+    egScore = entry.egScore;
+    return hit;
+}
+
+void PawnHashTable::trace(const Board& board, PawnTrace& counts) {
+    PawnEntry entry;
+    evaluateStructure(board, entry, &counts);
+    
+    for (int c = 0; c < 2; c++) {
+        Color color = c == 0 ? Color::WHITE : Color::BLACK;
+        Position kingPos = board.getKingPosition(color);
+        if (kingPos.isValid()) {
+            evaluateShelter(entry, color, kingPos, &counts);
+        }
+    }
+}
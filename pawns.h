@@ -0,0 +1,92 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include "main.h"
+#include "piece.h"
+
+class Board;
+
+// Cached pawn structure evaluation for one pawn configuration
+struct PawnEntry {
+    uint64_t key;        // Pawn-only Zobrist key
+    int mgScore;         // Structure score (white - black), midgame
+    int egScore;         // Structure score (white - black), endgame
+    int8_t fileCount[2][8];  // Pawns per file [color][file]
+    uint8_t pawnRows[2][8];  // Rows holding a pawn per file [color][file], one bit per row
+    int kingSquare[2];   // King square the shelter score was computed for
+    int shelter[2];      // Pawn shield and storm score for that king (midgame)
+    
+    // An empty entry is the valid entry for a board without pawns (key 0)
+    PawnEntry() : key(0), mgScore(0), egScore(0), kingSquare{-1, -1}, shelter{0, 0} {
+        for (int c = 0; c < 2; c++) {
+            for (int f = 0; f < 8; f++) {
+                fileCount[c][f] = 0;
+                pawnRows[c][f] = 0;
+            }
+        }
+    }
+};
+
+// How many times each pawn weight applies to a position, white minus black.
+// The tuner fits the weights from these counts.
+struct PawnTrace {
+    int doubled[2];      // Doubled pawns {midgame, endgame}
+    int isolated[2];
+    int backward[2];
+    int passedMg[8];     // Passed pawns by relative rank
+    int passedEg[8];
+    int shield[4];       // Shield pawns by distance to the king (midgame)
+    int storm[5];        // Storming pawns by distance to the king (midgame)
+    
+    PawnTrace() : doubled{}, isolated{}, backward{}, passedMg{}, passedEg{}, shield{}, storm{} {}
+};
+
+// Pawn hash table. Pawn structure changes rarely during search, so the
+// passed/isolated/doubled/backward terms are computed once per pawn
+// configuration and king shelter once per king square.
+class PawnHashTable {
+    // The tuner reads the weights it starts from
+    friend class Tuner;
+    
+private:
+    std::vector<PawnEntry> table;
+    size_t mask;
+    
+    // Structure weights: {midgame, endgame}
+    static const int doubledPenalty[2];
+    static const int isolatedPenalty[2];
+    static const int backwardPenalty[2];
+    
+    // Passed pawn bonus by relative rank (0 = 1st rank)
+    static const int passedBonusMg[8];
+    static const int passedBonusEg[8];
+    
+    // King shelter: own pawn on a file in front of the king by distance (none =
+    // index 0), and enemy pawn storming the file by distance
+    static const int shieldBonus[4];
+    static const int stormPenalty[5];
+    
+    // Compute the structure terms for the pawns on the board, counting the
+    // weights used in trace if given
+    static void evaluateStructure(const Board& board, PawnEntry& entry, PawnTrace* trace = nullptr);
+    
+    // Pawn shield and pawn storm score for a king of the given color
+    static int evaluateShelter(const PawnEntry& entry, Color color, const Position& kingPos,
+                               PawnTrace* trace = nullptr);
+    
+public:
+    // Constructor with the number of entries (rounded down to a power of 2)
+    PawnHashTable(size_t entries = 16384);
+    
+    // Clear the table
+    void clear();
+    
+    // Pawn structure and king shelter scores (white - black) for the position.
+    // Returns true if the structure terms were found in the table.
+    bool evaluate(const Board& board, int& mgScore, int& egScore);
+    
+    // Count the pawn weights that apply to the position, bypassing the table
+    static void trace(const Board& board, PawnTrace& counts);
+};
+
+#endif // PAWNS_H
@@ -54,9 +54,17 @@ public:
     Position to;
     PieceType promotion;
     
+    Move() : promotion(PieceType::NONE) {}
+    
     Move(Position f, Position t, PieceType p = PieceType::NONE)
         : from(f), to(t), promotion(p) {}
     
+    bool operator==(const Move& other) const {
+        return from == other.from && to == other.to && promotion == other.promotion;
+    }
+    
+    bool operator!=(const Move& other) const { return !(*this == other); }
+    
     std::string toString() const {
         std::string result = from.toString() + to.toString();
         if (promotion != PieceType::NONE) {
@@ -74,6 +82,13 @@ public:
     }
 };
 
+// Kinds of moves a piece generates
+enum class MoveFilter {
+    ALL,        // Every pseudo-legal move
+    TACTICAL,   // Captures (en passant included) and promotions only
+    QUIET       // Every other move, castling included
+};
+
 class Piece {
 protected:
     PieceType type;
@@ -96,7 +111,10 @@ public:
     void setMoved() { hasMoved = true; }
 void setHasMoved(bool moved) { hasMoved = moved; }
     
-    virtual std::vector<Move> getLegalMoves(const class Board& board) const = 0;
+    std::vector<Move> getLegalMoves(const class Board& board) const { return generateMoves(board, MoveFilter::ALL); }
+    
+    // Pseudo-legal moves of the given kind; the king safety check is left to the board
+    virtual std::vector<Move> generateMoves(const class Board& board, MoveFilter filter) const = 0;
     
     // Helper to check if move is on board and doesn't capture own piece
     bool isBasicallyValid(const Position& pos, const Board& board) const;
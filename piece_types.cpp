@@ -2,8 +2,10 @@
 #include "board.h"
 
 // Pawn movement logic
-std::vector<Move> Pawn::getLegalMoves(const Board& board) const {
+std::vector<Move> Pawn::generateMoves(const Board& board, MoveFilter filter) const {
     std::vector<Move> moves;
+    bool quiets = filter != MoveFilter::TACTICAL;
+    bool tactical = filter != MoveFilter::QUIET;
     int direction = (color == Color::WHITE) ? 1 : -1;
     Position front(position.row + direction, position.col);
     
@@ -11,17 +13,19 @@ std::vector<Move> Pawn::getLegalMoves(const Board& board) const {
     if (front.isValid() && !board.getPieceAt(front)) {
         // Check for promotion
         if (front.row == 0 || front.row == 7) {
-            moves.emplace_back(position, front, PieceType::QUEEN);
-            moves.emplace_back(position, front, PieceType::ROOK);
-            moves.emplace_back(position, front, PieceType::BISHOP);
-            moves.emplace_back(position, front, PieceType::KNIGHT);
-        } else {
+            if (tactical) {
+                moves.emplace_back(position, front, PieceType::QUEEN);
+                moves.emplace_back(position, front, PieceType::ROOK);
+                moves.emplace_back(position, front, PieceType::BISHOP);
+                moves.emplace_back(position, front, PieceType::KNIGHT);
+            }
+        } else if (quiets) {
             moves.emplace_back(position, front);
         }
         
         // Forward move (2 squares) if pawn is on starting row
-        if ((color == Color::WHITE && position.row == 1) || 
-            (color == Color::BLACK && position.row == 6)) {
+        if (quiets && ((color == Color::WHITE && position.row == 1) ||
+                       (color == Color::BLACK && position.row == 6))) {
             Position doubleFront(position.row + 2 * direction, position.col);
             if (doubleFront.isValid() && !board.getPieceAt(doubleFront)) {
                 moves.emplace_back(position, doubleFront);
@@ -30,28 +34,30 @@ std::vector<Move> Pawn::getLegalMoves(const Board& board) const {
     }
     
     // Capture moves (including en passant)
-    for (int dCol : {-1, 1}) {
-        Position capturePos(position.row + direction, position.col + dCol);
-        
-        if (capturePos.isValid()) {
-            auto pieceAtCapture = board.getPieceAt(capturePos);
+    if (tactical) {
+        for (int dCol : {-1, 1}) {
+            Position capturePos(position.row + direction, position.col + dCol);
             
-            // Regular capture
-            if (pieceAtCapture && pieceAtCapture->getColor() != color) {
-                // Check for promotion
-                if (capturePos.row == 0 || capturePos.row == 7) {
-                    moves.emplace_back(position, capturePos, PieceType::QUEEN);
-                    moves.emplace_back(position, capturePos, PieceType::ROOK);
-                    moves.emplace_back(position, capturePos, PieceType::BISHOP);
-                    moves.emplace_back(position, capturePos, PieceType::KNIGHT);
-                } else {
+            if (capturePos.isValid()) {
+                auto pieceAtCapture = board.getPieceAt(capturePos);
+                
+                // Regular capture
+                if (pieceAtCapture && pieceAtCapture->getColor() != color) {
+                    // Check for promotion
+                    if (capturePos.row == 0 || capturePos.row == 7) {
+                        moves.emplace_back(position, capturePos, PieceType::QUEEN);
+                        moves.emplace_back(position, capturePos, PieceType::ROOK);
+                        moves.emplace_back(position, capturePos, PieceType::BISHOP);
+                        moves.emplace_back(position, capturePos, PieceType::KNIGHT);
+                    } else {
+                        moves.emplace_back(position, capturePos);
+                    }
+                }
+                // En passant capture
+                else if (capturePos == board.getEnPassantTarget()) {
                     moves.emplace_back(position, capturePos);
                 }
             }
-            // En passant capture
-            else if (capturePos == board.getEnPassantTarget()) {
-                moves.emplace_back(position, capturePos);
-            }
         }
     }
     
@@ -59,8 +65,10 @@ std::vector<Move> Pawn::getLegalMoves(const Board& board) const {
 }
 
 // Knight movement logic
-std::vector<Move> Knight::getLegalMoves(const Board& board) const {
+std::vector<Move> Knight::generateMoves(const Board& board, MoveFilter filter) const {
     std::vector<Move> moves;
+    bool quiets = filter != MoveFilter::TACTICAL;
+    bool tactical = filter != MoveFilter::QUIET;
     const std::vector<std::pair<int, int>> knightOffsets = {
         {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
         {1, -2}, {1, 2}, {2, -1}, {2, 1}
@@ -69,7 +77,7 @@ std::vector<Move> Knight::getLegalMoves(const Board& board) const {
     for (const auto& offset : knightOffsets) {
         Position newPos(position.row + offset.first, position.col + offset.second);
         
-        if (isBasicallyValid(newPos, board)) {
+        if (isBasicallyValid(newPos, board) && (board.getPieceAt(newPos) ? tactical : quiets)) {
             moves.emplace_back(position, newPos);
         }
     }
@@ -78,8 +86,10 @@ std::vector<Move> Knight::getLegalMoves(const Board& board) const {
 }
 
 // Bishop movement logic
-std::vector<Move> Bishop::getLegalMoves(const Board& board) const {
+std::vector<Move> Bishop::generateMoves(const Board& board, MoveFilter filter) const {
     std::vector<Move> moves;
+    bool quiets = filter != MoveFilter::TACTICAL;
+    bool tactical = filter != MoveFilter::QUIET;
     const std::vector<std::pair<int, int>> directions = {
         {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
     };
@@ -95,10 +105,10 @@ std::vector<Move> Bishop::getLegalMoves(const Board& board) const {
             
             if (!pieceAtDest) {
                 // Empty square, can move here
-                moves.emplace_back(position, newPos);
+                if (quiets) moves.emplace_back(position, newPos);
             } else if (pieceAtDest->getColor() != color) {
                 // Capture opponent's piece
-                moves.emplace_back(position, newPos);
+                if (tactical) moves.emplace_back(position, newPos);
                 break;
             } else {
                 // Blocked by own piece
@@ -111,8 +121,10 @@ std::vector<Move> Bishop::getLegalMoves(const Board& board) const {
 }
 
 // Rook movement logic
-std::vector<Move> Rook::getLegalMoves(const Board& board) const {
+std::vector<Move> Rook::generateMoves(const Board& board, MoveFilter filter) const {
     std::vector<Move> moves;
+    bool quiets = filter != MoveFilter::TACTICAL;
+    bool tactical = filter != MoveFilter::QUIET;
     const std::vector<std::pair<int, int>> directions = {
         {-1, 0}, {1, 0}, {0, -1}, {0, 1}
     };
@@ -128,10 +140,10 @@ std::vector<Move> Rook::getLegalMoves(const Board& board) const {
             
             if (!pieceAtDest) {
                 // Empty square, can move here
-                moves.emplace_back(position, newPos);
+                if (quiets) moves.emplace_back(position, newPos);
             } else if (pieceAtDest->getColor() != color) {
                 // Capture opponent's piece
-                moves.emplace_back(position, newPos);
+                if (tactical) moves.emplace_back(position, newPos);
                 break;
             } else {
                 // Blocked by own piece
@@ -144,8 +156,10 @@ std::vector<Move> Rook::getLegalMoves(const Board& board) const {
 }
 
 // Queen movement logic
-std::vector<Move> Queen::getLegalMoves(const Board& board) const {
+std::vector<Move> Queen::generateMoves(const Board& board, MoveFilter filter) const {
     std::vector<Move> moves;
+    bool quiets = filter != MoveFilter::TACTICAL;
+    bool tactical = filter != MoveFilter::QUIET;
     const std::vector<std::pair<int, int>> directions = {
         {-1, -1}, {-1, 0}, {-1, 1},
         {0, -1},           {0, 1},
@@ -163,10 +177,10 @@ std::vector<Move> Queen::getLegalMoves(const Board& board) const {
             
             if (!pieceAtDest) {
                 // Empty square, can move here
-                moves.emplace_back(position, newPos);
+                if (quiets) moves.emplace_back(position, newPos);
             } else if (pieceAtDest->getColor() != color) {
                 // Capture opponent's piece
-                moves.emplace_back(position, newPos);
+                if (tactical) moves.emplace_back(position, newPos);
                 break;
             } else {
                 // Blocked by own piece
@@ -179,8 +193,10 @@ std::vector<Move> Queen::getLegalMoves(const Board& board) const {
 }
 
 // King movement logic
-std::vector<Move> King::getLegalMoves(const Board& board) const {
+std::vector<Move> King::generateMoves(const Board& board, MoveFilter filter) const {
     std::vector<Move> moves;
+    bool quiets = filter != MoveFilter::TACTICAL;
+    bool tactical = filter != MoveFilter::QUIET;
     const std::vector<std::pair<int, int>> directions = {
         {-1, -1}, {-1, 0}, {-1, 1},
         {0, -1},           {0, 1},
@@ -191,13 +207,14 @@ std::vector<Move> King::getLegalMoves(const Board& board) const {
     for (const auto& dir : directions) {
         Position newPos(position.row + dir.first, position.col + dir.second);
         
-        if (isBasicallyValid(newPos, board)) {
+        if (isBasicallyValid(newPos, board) && (board.getPieceAt(newPos) ? tactical : quiets)) {
             moves.emplace_back(position, newPos);
         }
     }
     
-    // Castling moves
-    if (!hasMoved && !board.isInCheck()) {
+    // Castling moves (only for the side to move - castling never attacks a square,
+    // and checking it for the opponent would recurse through isSquareAttacked)
+    if (quiets && color == board.getSideToMove() && !hasMoved && !board.isInCheck()) {
         // Kingside castling
         Position kingsidePos(position.row, position.col + 2);
         if (position.col == 4 && 
@@ -0,0 +1,60 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include "main.h"
+#include "piece.h"
+
+// Material and piece-square values for the tapered evaluation. Every piece has
+// a midgame and an endgame score; the board sums both incrementally and the
+// evaluation blends them by the game phase (remaining non-pawn material).
+class PSQT {
+    // The tuner reads the tables it starts from
+    friend class Tuner;
+    
+private:
+    // Piece-square tables, written from white's point of view with rank 8 on top
+    static const int pawnTable[64];
+    static const int knightTable[64];
+    static const int bishopTable[64];
+    static const int rookTable[64];
+    static const int queenTable[64];
+    static const int kingMiddleGameTable[64];
+    static const int kingEndGameTable[64];
+    
+    // Tables indexed by piece type
+    static const int* const mgTables[6];
+    static const int* const egTables[6];
+    
+    // Material values indexed by piece type (the king is never traded)
+    static const int mgValues[6];
+    static const int egValues[6];
+    
+    // Phase contribution of each piece type
+    static const int phaseValues[6];
+    
+    // Table index of a square for a piece of the given color
+    static int tableIndex(Color color, const Position& pos) {
+        return color == Color::WHITE ? (7 - pos.row) * 8 + pos.col : pos.row * 8 + pos.col;
+    }
+    
+public:
+    // Game phase with all non-pawn pieces on the board
+    static constexpr int MAX_PHASE = 24;
+    
+    // Midgame score (material + position) of a piece, positive for white
+    static int mg(PieceType type, Color color, const Position& pos) {
+        int score = mgValues[static_cast<int>(type)] + mgTables[static_cast<int>(type)][tableIndex(color, pos)];
+        return color == Color::WHITE ? score : -score;
+    }
+    
+    // Endgame score (material + position) of a piece, positive for white
+    static int eg(PieceType type, Color color, const Position& pos) {
+        int score = egValues[static_cast<int>(type)] + egTables[static_cast<int>(type)][tableIndex(color, pos)];
+        return color == Color::WHITE ? score : -score;
+    }
+    
+    // Phase contribution of a piece
+    static int phase(PieceType type) { return phaseValues[static_cast<int>(type)]; }
+};
+
+#endif // PSQT_H
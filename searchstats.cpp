@@ -0,0 +1,126 @@
+#include "searchstats.h"
+#include <sstream>
+#include <iomanip>
+
+void SearchStats::reset() {
+    nodes = 0;
+    qnodes = 0;
+    ttProbes = 0;
+    ttHits = 0;
+    ttCutoffs = 0;
+    betaCutoffs = 0;
+    for (long& count : cutoffsByMove) count = 0;
+    nullMoveTries = 0;
+    nullMoveCutoffs = 0;
+    lmrReductions = 0;
+    lmrResearches = 0;
+    reverseFutilityCuts = 0;
+    futilityPrunes = 0;
+    lateMovePrunes = 0;
+    aspirationResearches = 0;
+    evalCacheHits = 0;
+    evalCacheMisses = 0;
+    pawnHashProbes = 0;
+    pawnHashHits = 0;
+    depth = 0;
+    selDepth = 0;
+    timeMs = 0;
+    bookMove = false;
+}
+
+void SearchStats::merge(const SearchStats& other) {
+    nodes += other.nodes;
+    qnodes += other.qnodes;
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    ttCutoffs += other.ttCutoffs;
+    betaCutoffs += other.betaCutoffs;
+    for (int i = 0; i < STATS_CUTOFF_BUCKETS; i++) cutoffsByMove[i] += other.cutoffsByMove[i];
+    nullMoveTries += other.nullMoveTries;
+    nullMoveCutoffs += other.nullMoveCutoffs;
+    lmrReductions += other.lmrReductions;
+    lmrResearches += other.lmrResearches;
+    reverseFutilityCuts += other.reverseFutilityCuts;
+    futilityPrunes += other.futilityPrunes;
+    lateMovePrunes += other.lateMovePrunes;
+    aspirationResearches += other.aspirationResearches;
+    evalCacheHits += other.evalCacheHits;
+    evalCacheMisses += other.evalCacheMisses;
+    pawnHashProbes += other.pawnHashProbes;
+    pawnHashHits += other.pawnHashHits;
+    depth = std::max(depth, other.depth);
+    selDepth = std::max(selDepth, other.selDepth);
+    timeMs += other.timeMs;
+}
+
+// Percentage of part in total, for the summary
+static double percent(long part, long total) {
+    return total > 0 ? 100.0 * part / total : 0.0;
+}
+
+void SearchStats::print(std::ostream& out) const {
+    std::ios::fmtflags savedFlags = out.flags();
+    std::streamsize savedPrecision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    if (bookMove) {
+        out << "Book move        : nothing searched" << std::endl;
+    }
+    out << "Depth / seldepth : " << depth << " / " << selDepth << std::endl;
+    out << "Time (ms)        : " << timeMs << std::endl;
+    out << "Nodes            : " << nodes << " (" << qnodes << " quiescence)" << std::endl;
+    out << "Nodes/second     : " << nodesPerSecond() << std::endl;
+    out << "TT probes        : " << ttProbes << ", hits " << percent(ttHits, ttProbes)
+        << "%, cutoffs " << percent(ttCutoffs, ttProbes) << "%" << std::endl;
+    out << "Beta cutoffs     : " << betaCutoffs << ", first move " << 100.0 * firstMoveCutoffRate() << "%" << std::endl;
+    out << "Cutoffs by move  :";
+    for (int i = 0; i < STATS_CUTOFF_BUCKETS; i++) {
+        out << " " << (i + 1) << (i == STATS_CUTOFF_BUCKETS - 1 ? "+" : "") << ":" << cutoffsByMove[i];
+    }
+    out << std::endl;
+    out << "Null move        : " << nullMoveTries << " tries, " << nullMoveCutoffs << " cutoffs" << std::endl;
+    out << "LMR              : " << lmrReductions << " reductions, " << lmrResearches << " re-searches" << std::endl;
+    out << "RFP cutoffs      : " << reverseFutilityCuts << std::endl;
+    out << "Futility prunes  : " << futilityPrunes << std::endl;
+    out << "LMP prunes       : " << lateMovePrunes << std::endl;
+    out << "Aspiration fails : " << aspirationResearches << std::endl;
+    out << "Eval cache       : " << evalCacheHits + evalCacheMisses << " probes, hits "
+        << percent(evalCacheHits, evalCacheHits + evalCacheMisses) << "%" << std::endl;
+    out << "Pawn hash        : " << pawnHashProbes << " probes, hits "
+        << percent(pawnHashHits, pawnHashProbes) << "%" << std::endl;
+    out.flags(savedFlags);
+    out.precision(savedPrecision);
+}
+
+std::string SearchStats::toJSON() const {
+    std::ostringstream ss;
+    ss << "{\"depth\":" << depth
+       << ",\"seldepth\":" << selDepth
+       << ",\"time_ms\":" << timeMs
+       << ",\"nodes\":" << nodes
+       << ",\"qnodes\":" << qnodes
+       << ",\"nps\":" << nodesPerSecond()
+       << ",\"tt_probes\":" << ttProbes
+       << ",\"tt_hits\":" << ttHits
+       << ",\"tt_cutoffs\":" << ttCutoffs
+       << ",\"beta_cutoffs\":" << betaCutoffs
+       << ",\"first_move_cutoff_rate\":" << std::setprecision(4) << firstMoveCutoffRate()
+       << ",\"cutoffs_by_move\":[";
+    for (int i = 0; i < STATS_CUTOFF_BUCKETS; i++) {
+        ss << (i > 0 ? "," : "") << cutoffsByMove[i];
+    }
+    ss << "],\"null_move_tries\":" << nullMoveTries
+       << ",\"null_move_cutoffs\":" << nullMoveCutoffs
+       << ",\"lmr_reductions\":" << lmrReductions
+       << ",\"lmr_researches\":" << lmrResearches
+       << ",\"rfp_cutoffs\":" << reverseFutilityCuts
+       << ",\"futility_prunes\":" << futilityPrunes
+       << ",\"lmp_prunes\":" << lateMovePrunes
+       << ",\"aspiration_researches\":" << aspirationResearches
+       << ",\"eval_cache_hits\":" << evalCacheHits
+       << ",\"eval_cache_misses\":" << evalCacheMisses
+       << ",\"pawn_hash_probes\":" << pawnHashProbes
+       << ",\"pawn_hash_hits\":" << pawnHashHits
+       << ",\"book_move\":" << (bookMove ? "true" : "false")
+       << "}";
+    return ss.str();
+}
@@ -0,0 +1,60 @@
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include "main.h"
+
+// Beta cutoffs are counted by the index of the cutoff move; the last bucket
+// holds every move from that index on
+constexpr int STATS_CUTOFF_BUCKETS = 8;
+
+// Counters of one search. Each searching engine (thread) owns its own copy
+// and updates it without atomics or locks; merge() adds up the copies.
+struct SearchStats {
+    long nodes;                 // All nodes, main search and quiescence
+    long qnodes;                // Quiescence search nodes
+    long ttProbes;              // Transposition table probes
+    long ttHits;                // Probes that found the position
+    long ttCutoffs;             // Probes whose score ended the node
+    long betaCutoffs;           // Main search nodes that failed high on a move
+    long cutoffsByMove[STATS_CUTOFF_BUCKETS];
+    long nullMoveTries;         // Null-move searches
+    long nullMoveCutoffs;       // Null-move searches that cut the node
+    long lmrReductions;         // Moves searched at reduced depth
+    long lmrResearches;         // Reduced searches repeated at full depth
+    long reverseFutilityCuts;   // Nodes cut by reverse futility pruning
+    long futilityPrunes;        // Quiet moves skipped by futility pruning
+    long lateMovePrunes;        // Quiet moves skipped by late move count pruning
+    long aspirationResearches;  // Root searches repeated with a wider window
+    long evalCacheHits;         // Static evaluations found in the eval cache
+    long evalCacheMisses;       // Static evaluations computed
+    long pawnHashProbes;        // Pawn structure lookups
+    long pawnHashHits;          // Lookups that found the pawn structure
+    int depth;                  // Last completed iteration
+    int selDepth;               // Deepest ply reached
+    long timeMs;                // Time spent until the last completed iteration
+    bool bookMove;              // Move came from the opening book, nothing was searched
+
+    SearchStats() { reset(); }
+
+    // Zero every counter
+    void reset();
+
+    // Add the counters of another search (depths are maxed)
+    void merge(const SearchStats& other);
+
+    // Share of the beta cutoffs produced by the first move searched
+    double firstMoveCutoffRate() const {
+        return betaCutoffs > 0 ? static_cast<double>(cutoffsByMove[0]) / betaCutoffs : 0.0;
+    }
+
+    // Nodes per second, 0 if no time has been measured
+    long nodesPerSecond() const { return timeMs > 0 ? nodes * 1000 / timeMs : 0; }
+
+    // Human-readable summary, one counter per line
+    void print(std::ostream& out) const;
+
+    // Single-line JSON object with every counter
+    std::string toJSON() const;
+};
+
+#endif // SEARCHSTATS_H
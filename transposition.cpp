@@ -22,7 +22,7 @@ void TranspositionTable::resize(int sizeMB) {
     clear();
 }
 
-void TranspositionTable::store(uint64_t key, int depth, int score, NodeType type, const Move& bestMove) {
+void TranspositionTable::store(uint64_t key, int depth, int score, NodeType type, const Move& bestMove, int ply) {
     size_t idx = index(key);
     TTEntry& entry = table[idx];
     
@@ -35,36 +35,39 @@ void TranspositionTable::store(uint64_t key, int depth, int score, NodeType type
         depth >= entry.depth || // Deeper search
         currentAge != entry.age) { // Older entry
         
-        entry = TTEntry(key, depth, score, type, bestMove, currentAge);
+        entry = TTEntry(key, depth, scoreToTT(score, ply), type, bestMove, currentAge);
     }
 }
 
-bool TranspositionTable::probe(uint64_t key, int depth, int alpha, int beta, int& score, Move& bestMove) {
+bool TranspositionTable::probe(uint64_t key, int depth, int alpha, int beta, int& score, Move& bestMove, int ply, bool& found) {
     size_t idx = index(key);
     TTEntry& entry = table[idx];
     
     // Check if we have a matching position
-    if (entry.key == key) {
+    found = entry.key == key;
+    if (found) {
         // Always return the best move, even if we can't use the score
         bestMove = entry.bestMove;
         
         // Only use the score if the depth is sufficient
         if (entry.depth >= depth) {
+            int entryScore = scoreFromTT(entry.score, ply);
+            
             // Adjust the score based on the node type
             switch (entry.type) {
                 case NodeType::EXACT:
-                    score = entry.score;
+                    score = entryScore;
                     return true;
                 
                 case NodeType::ALPHA:
-                    if (entry.score <= alpha) {
+                    if (entryScore <= alpha) {
                         score = alpha;
                         return true;
                     }
                     break;
                 
                 case NodeType::BETA:
-                    if (entry.score >= beta) {
+                    if (entryScore >= beta) {
                         score = beta;
                         return true;
                     }
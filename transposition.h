@@ -11,6 +11,14 @@ enum class NodeType {
     BETA        // Lower bound (fail-high)
 };
 
+// Score of checkmate: being mated n plies from the root scores -MATE_SCORE + n
+const int MATE_SCORE = 100000;
+
+// Scores beyond this bound are mates, whose distance is counted from the
+// root. The table stores them relative to the node instead, so they stay
+// correct when the position is reached at another ply.
+const int DECISIVE_BOUND = MATE_SCORE - 1000;
+
 // Structure for transposition table entries
 struct TTEntry {
     uint64_t key;         // Zobrist hash key
@@ -39,11 +47,20 @@ public:
     // Resize the table
     void resize(int sizeMB);
     
-    // Store a position in the table
-    void store(uint64_t key, int depth, int score, NodeType type, const Move& bestMove);
+    // Store a position searched at the given ply from the root
+    void store(uint64_t key, int depth, int score, NodeType type, const Move& bestMove, int ply);
     
-    // Probe the table for a position
-    bool probe(uint64_t key, int depth, int alpha, int beta, int& score, Move& bestMove);
+    // Probe the table for a position reached at the given ply from the root;
+    // found is set when the position is in the table, even if its score can't be used
+    bool probe(uint64_t key, int depth, int alpha, int beta, int& score, Move& bestMove, int ply, bool& found);
+    
+    // Copy the entry for a position without using its score; false if there is none
+    bool lookup(uint64_t key, TTEntry& entry) const {
+        const TTEntry& stored = table[index(key)];
+        if (stored.key != key) return false;
+        entry = stored;
+        return true;
+    }
     
     // Clear the table
     void clear();
@@ -59,6 +76,14 @@ public:
     
     // Calculate the index in the table for a given key
     size_t index(uint64_t key) const { return key % size; }
+    
+    // Convert mate scores between root-relative and node-relative
+    static int scoreToTT(int score, int ply) {
+        return score >= DECISIVE_BOUND ? score + ply : score <= -DECISIVE_BOUND ? score - ply : score;
+    }
+    static int scoreFromTT(int score, int ply) {
+        return score >= DECISIVE_BOUND ? score - ply : score <= -DECISIVE_BOUND ? score + ply : score;
+    }
 };
 
 #endif // TRANSPOSITION_H
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "main.h"
+#include "tuner.h"
+#include <thread>
+
+// Texel tuner: tune <dataset> [iterations] [threads] [learning rate]
+// Progress goes to stderr, the tuned definitions to stdout.
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: tune <dataset> [iterations] [threads] [learning rate]" << std::endl;
+        return 1;
+    }
+    
+    int iterations = 1000;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    double learningRate = 1.0;
+    try {
+        if (argc > 2) iterations = std::stoi(argv[2]);
+        if (argc > 3) threads = std::stoi(argv[3]);
+        if (argc > 4) learningRate = std::stod(argv[4]);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid argument!" << std::endl;
+        return 1;
+    }
+    
+    Tuner tuner(threads);
+    if (tuner.load(argv[1]) == 0) {
+        std::cerr << "No labeled positions found in " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    tuner.tune(iterations, learningRate);
+    tuner.printTables(std::cout);
+    return 0;
+}
@@ -0,0 +1,404 @@
+#include "tuner.h"
+#include "board.h"
+#include "psqt.h"
+#include "pawns.h"
+#include "mobility.h"
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <iomanip>
+#include <algorithm>
+
+// Parameter layout: midgame values (pawn..queen), endgame values, then seven
+// 64-square tables: pawn, knight, bishop, rook and queen (shared by both
+// phases), king midgame and king endgame
+static const int MG_VALUE = 0;
+static const int EG_VALUE = 5;
+static const int TABLES = 10;
+
+// Then the pawn structure and piece activity weights, {midgame, endgame}
+// pairs unless noted
+static const int DOUBLED = TABLES + 7 * 64;
+static const int ISOLATED = DOUBLED + 2;
+static const int BACKWARD = ISOLATED + 2;
+static const int PASSED_MG = BACKWARD + 2;         // By relative rank
+static const int PASSED_EG = PASSED_MG + 8;
+static const int SHIELD = PASSED_EG + 8;           // By distance, midgame only
+static const int STORM = SHIELD + 4;               // By distance, midgame only
+static const int MOBILITY = STORM + 5;             // Pair per piece type (knight..queen)
+static const int KING_ATTACK = MOBILITY + 4 * 2;   // By piece type, midgame only
+static const int ROOK_OPEN = KING_ATTACK + 4;
+static const int ROOK_SEMI_OPEN = ROOK_OPEN + 2;
+static const int BISHOP_PAIR = ROOK_SEMI_OPEN + 2;
+static const int NUM_PARAMS = BISHOP_PAIR + 2;
+
+static int mgTable(int type) { return TABLES + type * 64; }
+static int egTable(int type) { return TABLES + (type == 5 ? 6 : type) * 64; }
+
+Tuner::Tuner(int threads) : params(NUM_PARAMS), threads(std::max(1, threads)) {
+    for (int t = 0; t < 5; t++) {
+        params[MG_VALUE + t] = PSQT::mgValues[t];
+        params[EG_VALUE + t] = PSQT::egValues[t];
+    }
+    for (int t = 0; t < 6; t++) {
+        for (int sq = 0; sq < 64; sq++) {
+            params[mgTable(t) + sq] = PSQT::mgTables[t][sq];
+            params[egTable(t) + sq] = PSQT::egTables[t][sq];
+        }
+    }
+    
+    for (int phase = 0; phase < 2; phase++) {
+        params[DOUBLED + phase] = PawnHashTable::doubledPenalty[phase];
+        params[ISOLATED + phase] = PawnHashTable::isolatedPenalty[phase];
+        params[BACKWARD + phase] = PawnHashTable::backwardPenalty[phase];
+        params[ROOK_OPEN + phase] = Mobility::rookOpenFile[phase];
+        params[ROOK_SEMI_OPEN + phase] = Mobility::rookSemiOpenFile[phase];
+        params[BISHOP_PAIR + phase] = Mobility::bishopPair[phase];
+    }
+    for (int rank = 0; rank < 8; rank++) {
+        params[PASSED_MG + rank] = PawnHashTable::passedBonusMg[rank];
+        params[PASSED_EG + rank] = PawnHashTable::passedBonusEg[rank];
+    }
+    for (int i = 0; i < 4; i++) params[SHIELD + i] = PawnHashTable::shieldBonus[i];
+    for (int i = 0; i < 5; i++) params[STORM + i] = PawnHashTable::stormPenalty[i];
+    for (int t = 0; t < 4; t++) {
+        params[MOBILITY + t * 2] = Mobility::mobilityWeight[t][0];
+        params[MOBILITY + t * 2 + 1] = Mobility::mobilityWeight[t][1];
+        params[KING_ATTACK + t] = Mobility::kingAttackWeight[t];
+    }
+}
+
+// A token without the quotes, brackets and semicolons used around results
+static std::string stripResultToken(const std::string& token) {
+    std::string value;
+    for (char c : token) {
+        if (c != '"' && c != '[' && c != ']' && c != ';') value += c;
+    }
+    return value;
+}
+
+// Halfmove clock or fullmove number of a FEN
+static bool isCounter(const std::string& value) {
+    return std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+// Result for white (0 = loss, 1 = draw, 2 = win), or -1 if the token isn't one
+static int parseResult(const std::string& value) {
+    if (value == "1-0" || value == "1.0") return 2;
+    if (value == "0-1" || value == "0.0") return 0;
+    if (value == "1/2-1/2" || value == "0.5") return 1;
+    return -1;
+}
+
+size_t Tuner::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) return 0;
+
+    Board board;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        std::string placement, side, castling, enPassant;
+        if (!(ss >> placement >> side >> castling >> enPassant)) continue;
+
+        // The result follows the FEN and its move counters, or is the operand
+        // of an EPD c9 opcode. Anything else leaves the line unlabeled.
+        int result = -1;
+        int counters = 0;
+        bool first = true;
+        std::string token;
+        while (result < 0 && ss >> token) {
+            std::string value = stripResultToken(token);
+            if (value.empty()) continue;
+            if (value == "c9") {
+                if (ss >> token) result = parseResult(stripResultToken(token));
+                break;
+            }
+            if (first && counters < 2 && isCounter(value)) {
+                counters++;
+                continue;
+            }
+            if (first) result = parseResult(value);
+            first = false;
+        }
+        if (result < 0) continue;
+
+        // The clocks don't affect the evaluation
+        board.setupFromFEN(placement + " " + side + " " + castling + " " + enPassant + " 0 1");
+
+        TunerPosition pos;
+        pos.firstPiece = static_cast<uint32_t>(pieces.size());
+        pos.pieceCount = 0;
+        pos.firstTerm = static_cast<uint32_t>(terms.size());
+        pos.termCount = 0;
+        pos.phase = static_cast<uint8_t>(std::min(board.getGamePhase(), PSQT::MAX_PHASE));
+        pos.result = static_cast<uint8_t>(result);
+
+        for (int row = 0; row < 8; row++) {
+            for (int col = 0; col < 8; col++) {
+                Position square(row, col);
+                auto piece = board.getPieceAt(square);
+                if (!piece) continue;
+                int color = piece->getColor() == Color::WHITE ? 0 : 1;
+                int type = static_cast<int>(piece->getType());
+                pieces.push_back(static_cast<uint16_t>((color << 9) | (type << 6) | PSQT::tableIndex(piece->getColor(), square)));
+                pos.pieceCount++;
+            }
+        }
+
+        // The other weights are counted once with the engine's own evaluation code
+        auto addTerm = [&](int param, bool endgame, double count) {
+            if (count == 0) return;
+            terms.push_back({ static_cast<uint16_t>(param), endgame, static_cast<float>(count) });
+            pos.termCount++;
+        };
+        
+        PawnTrace pawnTrace;
+        PawnHashTable::trace(board, pawnTrace);
+        for (int phase = 0; phase < 2; phase++) {
+            addTerm(DOUBLED + phase, phase == 1, pawnTrace.doubled[phase]);
+            addTerm(ISOLATED + phase, phase == 1, pawnTrace.isolated[phase]);
+            addTerm(BACKWARD + phase, phase == 1, pawnTrace.backward[phase]);
+        }
+        for (int rank = 0; rank < 8; rank++) {
+            addTerm(PASSED_MG + rank, false, pawnTrace.passedMg[rank]);
+            addTerm(PASSED_EG + rank, true, pawnTrace.passedEg[rank]);
+        }
+        for (int i = 0; i < 4; i++) addTerm(SHIELD + i, false, pawnTrace.shield[i]);
+        for (int i = 0; i < 5; i++) addTerm(STORM + i, false, pawnTrace.storm[i]);
+        
+#ifdef USE_MOBILITY_EVAL
+        int activityMg, activityEg;
+        MobilityTrace mobilityTrace;
+        Mobility::evaluate(board, activityMg, activityEg, &mobilityTrace);
+        for (int phase = 0; phase < 2; phase++) {
+            for (int t = 0; t < 4; t++) {
+                addTerm(MOBILITY + t * 2 + phase, phase == 1, mobilityTrace.mobility[t][phase]);
+            }
+            addTerm(ROOK_OPEN + phase, phase == 1, mobilityTrace.rookOpenFile[phase]);
+            addTerm(ROOK_SEMI_OPEN + phase, phase == 1, mobilityTrace.rookSemiOpenFile[phase]);
+            addTerm(BISHOP_PAIR + phase, phase == 1, mobilityTrace.bishopPair[phase]);
+        }
+        for (int t = 0; t < 4; t++) addTerm(KING_ATTACK + t, false, mobilityTrace.kingAttack[t]);
+#endif
+        positions.push_back(pos);
+    }
+
+    return positions.size();
+}
+
+double Tuner::evaluate(const TunerPosition& pos) const {
+    double mg = 0.0;
+    double eg = 0.0;
+
+    for (uint32_t i = pos.firstPiece; i < pos.firstPiece + pos.pieceCount; i++) {
+        int sign = (pieces[i] >> 9) ? -1 : 1;
+        int type = (pieces[i] >> 6) & 7;
+        int square = pieces[i] & 63;
+        if (type < 5) {
+            mg += sign * params[MG_VALUE + type];
+            eg += sign * params[EG_VALUE + type];
+        }
+        mg += sign * params[mgTable(type) + square];
+        eg += sign * params[egTable(type) + square];
+    }
+
+    for (uint32_t i = pos.firstTerm; i < pos.firstTerm + pos.termCount; i++) {
+        (terms[i].endgame ? eg : mg) += terms[i].count * params[terms[i].param];
+    }
+
+    return (mg * pos.phase + eg * (PSQT::MAX_PHASE - pos.phase)) / PSQT::MAX_PHASE;
+}
+
+// Expected score for white given an evaluation in centipawns
+static double sigmoid(double k, double eval) {
+    return 1.0 / (1.0 + std::pow(10.0, -k * eval / 400.0));
+}
+
+double Tuner::totalError(double k) const {
+    std::vector<double> errors(threads, 0.0);
+    std::vector<std::thread> workers;
+    size_t chunk = (positions.size() + threads - 1) / threads;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            size_t end = std::min(positions.size(), (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; i++) {
+                double error = positions[i].result / 2.0 - sigmoid(k, evaluate(positions[i]));
+                errors[t] += error * error;
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    double total = 0.0;
+    for (double error : errors) total += error;
+    return total / std::max<size_t>(1, positions.size());
+}
+
+double Tuner::computeGradient(double k, std::vector<double>& gradient) const {
+    std::vector<std::vector<double>> partials(threads, std::vector<double>(NUM_PARAMS, 0.0));
+    std::vector<double> errors(threads, 0.0);
+    std::vector<std::thread> workers;
+    size_t chunk = (positions.size() + threads - 1) / threads;
+
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            std::vector<double>& partial = partials[t];
+            size_t end = std::min(positions.size(), (t + 1) * chunk);
+            for (size_t i = t * chunk; i < end; i++) {
+                const TunerPosition& pos = positions[i];
+                double s = sigmoid(k, evaluate(pos));
+                double error = pos.result / 2.0 - s;
+                errors[t] += error * error;
+
+                // d(error^2)/d(eval), split between the midgame and endgame parameters
+                double d = -2.0 * error * s * (1.0 - s) * k * std::log(10.0) / 400.0;
+                double dMg = d * pos.phase / PSQT::MAX_PHASE;
+                double dEg = d * (PSQT::MAX_PHASE - pos.phase) / PSQT::MAX_PHASE;
+
+                for (uint32_t p = pos.firstPiece; p < pos.firstPiece + pos.pieceCount; p++) {
+                    int sign = (pieces[p] >> 9) ? -1 : 1;
+                    int type = (pieces[p] >> 6) & 7;
+                    int square = pieces[p] & 63;
+                    if (type < 5) {
+                        partial[MG_VALUE + type] += sign * dMg;
+                        partial[EG_VALUE + type] += sign * dEg;
+                    }
+                    partial[mgTable(type) + square] += sign * dMg;
+                    partial[egTable(type) + square] += sign * dEg;
+                }
+
+                for (uint32_t p = pos.firstTerm; p < pos.firstTerm + pos.termCount; p++) {
+                    partial[terms[p].param] += terms[p].count * (terms[p].endgame ? dEg : dMg);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    double n = static_cast<double>(std::max<size_t>(1, positions.size()));
+    double total = 0.0;
+    gradient.assign(NUM_PARAMS, 0.0);
+    for (int t = 0; t < threads; t++) {
+        total += errors[t];
+        for (int i = 0; i < NUM_PARAMS; i++) gradient[i] += partials[t][i] / n;
+    }
+    return total / n;
+}
+
+double Tuner::findBestK() const {
+    // Coarse scan followed by successively finer ones around the best value
+    double best = 1.0;
+    double bestError = totalError(best);
+    for (double step = 0.1; step >= 0.001; step /= 10) {
+        double center = best;
+        for (int i = -10; i <= 10; i++) {
+            double k = center + i * step;
+            if (k <= 0) continue;
+            double error = totalError(k);
+            if (error < bestError) {
+                bestError = error;
+                best = k;
+            }
+        }
+    }
+    return best;
+}
+
+void Tuner::tune(int iterations, double learningRate) {
+    if (positions.empty()) return;
+
+    double k = findBestK();
+    std::cerr << "Positions: " << positions.size() << ", K = " << k
+              << ", initial error = " << totalError(k) << std::endl;
+
+    // Adam keeps the step size reasonable for rarely seen squares
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> m(NUM_PARAMS, 0.0), v(NUM_PARAMS, 0.0), gradient;
+
+    for (int iteration = 1; iteration <= iterations; iteration++) {
+        double error = computeGradient(k, gradient);
+
+        for (int i = 0; i < NUM_PARAMS; i++) {
+            m[i] = beta1 * m[i] + (1 - beta1) * gradient[i];
+            v[i] = beta2 * v[i] + (1 - beta2) * gradient[i] * gradient[i];
+            double mHat = m[i] / (1 - std::pow(beta1, iteration));
+            double vHat = v[i] / (1 - std::pow(beta2, iteration));
+            params[i] -= learningRate * mHat / (std::sqrt(vHat) + epsilon);
+        }
+
+        if (iteration % 50 == 0 || iteration == iterations) {
+            std::cerr << "Iteration " << iteration << ", error = " << std::setprecision(8) << error << std::endl;
+        }
+    }
+}
+
+void Tuner::printTables(std::ostream& out) const {
+    static const char* tableNames[7] = {
+        "pawnTable", "knightTable", "bishopTable", "rookTable", "queenTable",
+        "kingMiddleGameTable", "kingEndGameTable"
+    };
+
+    for (int table = 0; table < 7; table++) {
+        out << "const int PSQT::" << tableNames[table] << "[64] = {" << std::endl;
+        for (int row = 0; row < 8; row++) {
+            out << "    ";
+            for (int col = 0; col < 8; col++) {
+                int square = row * 8 + col;
+                out << std::setw(4) << static_cast<int>(std::lround(params[TABLES + table * 64 + square]));
+                if (square < 63) out << ",";
+            }
+            out << std::endl;
+        }
+        out << "};" << std::endl << std::endl;
+    }
+
+    const char* valueNames[2] = { "mgValues", "egValues" };
+    for (int phase = 0; phase < 2; phase++) {
+        out << "const int PSQT::" << valueNames[phase] << "[6] = { ";
+        for (int t = 0; t < 5; t++) {
+            out << std::lround(params[(phase == 0 ? MG_VALUE : EG_VALUE) + t]) << ", ";
+        }
+        out << "0 };" << std::endl;
+    }
+    out << std::endl;
+
+    // pawns.cpp
+    printWeights(out, "PawnHashTable::doubledPenalty", DOUBLED, 2);
+    printWeights(out, "PawnHashTable::isolatedPenalty", ISOLATED, 2);
+    printWeights(out, "PawnHashTable::backwardPenalty", BACKWARD, 2);
+    out << std::endl;
+    printWeights(out, "PawnHashTable::passedBonusMg", PASSED_MG, 8);
+    printWeights(out, "PawnHashTable::passedBonusEg", PASSED_EG, 8);
+    out << std::endl;
+    printWeights(out, "PawnHashTable::shieldBonus", SHIELD, 4);
+    printWeights(out, "PawnHashTable::stormPenalty", STORM, 5);
+    out << std::endl;
+
+    // mobility.cpp; the baselines and the attacker scaling aren't tuned
+    out << "const int Mobility::mobilityWeight[4][3] = {" << std::endl;
+    for (int t = 0; t < 4; t++) {
+        out << "    { " << std::lround(params[MOBILITY + t * 2]) << ", " << std::lround(params[MOBILITY + t * 2 + 1])
+            << ", " << Mobility::mobilityWeight[t][2] << " }" << (t < 3 ? "," : "") << std::endl;
+    }
+    out << "};" << std::endl << std::endl;
+    printWeights(out, "Mobility::kingAttackWeight", KING_ATTACK, 4);
+    out << std::endl;
+    out << "const int Mobility::attackerScale[8] = { ";
+    for (int i = 0; i < 8; i++) out << Mobility::attackerScale[i] << (i < 7 ? ", " : " };");
+    out << std::endl << std::endl;
+    printWeights(out, "Mobility::rookOpenFile", ROOK_OPEN, 2);
+    printWeights(out, "Mobility::rookSemiOpenFile", ROOK_SEMI_OPEN, 2);
+    out << std::endl;
+    printWeights(out, "Mobility::bishopPair", BISHOP_PAIR, 2);
+}
+
+void Tuner::printWeights(std::ostream& out, const char* name, int first, int count) const {
+    out << "const int " << name << "[" << count << "] = { ";
+    for (int i = 0; i < count; i++) {
+        out << std::lround(params[first + i]) << (i < count - 1 ? ", " : " };");
+    }
+    out << std::endl;
+}
@@ -0,0 +1,77 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include "main.h"
+
+// Texel-style tuning of the evaluation weights: the material values and
+// piece-square tables in PSQT, the pawn structure and king shelter weights
+// and the piece activity weights. Positions labeled with game results are
+// loaded once into a compact form; gradient descent then minimizes the
+// squared error between the results and the sigmoid of the evaluation.
+// The attacker count scaling and the mobility baselines stay fixed, since
+// the evaluation isn't linear in them.
+class Tuner {
+private:
+    // One dataset position: its pieces and weight counts live in the shared
+    // pieces and terms arrays
+    struct TunerPosition {
+        uint32_t firstPiece; // Index of the first piece in pieces
+        uint32_t firstTerm;  // Index of the first weight count in terms
+        uint8_t pieceCount;  // Number of non-king pieces plus kings
+        uint8_t termCount;   // Number of weights that apply
+        uint8_t phase;       // Game phase, clamped to PSQT::MAX_PHASE
+        uint8_t result;      // 0 = black won, 1 = draw, 2 = white won
+    };
+
+    // A pawn structure or activity weight applied count times (white - black)
+    struct TunerTerm {
+        uint16_t param;
+        bool endgame;
+        float count;
+    };
+
+    // Pieces packed as (color << 9) | (type << 6) | table index
+    std::vector<uint16_t> pieces;
+    std::vector<TunerTerm> terms;
+    std::vector<TunerPosition> positions;
+
+    // Parameters: material values, the piece-square tables, then the other
+    // weights (see tuner.cpp)
+    std::vector<double> params;
+
+    int threads;
+
+    // Evaluation of a position from white's point of view with the current parameters
+    double evaluate(const TunerPosition& pos) const;
+
+    // Mean squared error over the dataset for the sigmoid scaling constant k
+    double totalError(double k) const;
+
+    // Mean squared error and its gradient over the dataset
+    double computeGradient(double k, std::vector<double>& gradient) const;
+
+    // Scaling constant that best maps evaluations to results
+    double findBestK() const;
+
+    // Print count parameters from first as a C++ array definition
+    void printWeights(std::ostream& out, const char* name, int first, int count) const;
+
+public:
+    // Start from the current evaluation weights
+    Tuner(int threads);
+
+    // Load a dataset with one position per line: a FEN, with or without its
+    // move counters, followed by the game result ("1-0", "0-1", "1/2-1/2" or
+    // 1.0 / 0.5 / 0.0, optionally quoted or in brackets, or as an EPD c9
+    // operand). Returns the number of positions loaded.
+    size_t load(const std::string& path);
+
+    // Run gradient descent for the given number of iterations
+    void tune(int iterations, double learningRate);
+
+    // Print the tuned values as C++ definitions for psqt.cpp, pawns.cpp and
+    // mobility.cpp
+    void printTables(std::ostream& out) const;
+};
+
+#endif // TUNER_H
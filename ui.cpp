@@ -2,6 +2,7 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <sstream>
 
 void UI::newGame(bool playerPlaysWhite) {
     game.newGame();
@@ -216,9 +217,105 @@ bool UI::processCommand(const std::string& command) {
         } catch (const std::exception& e) {
             std::cout << "Invalid size!" << std::endl;
         }
+    } else if (command.substr(0, 10) == "evalcache ") {
+        try {
+            int sizeMB = std::stoi(command.substr(10));
+            if (sizeMB > 0) {
+                engine.setEvalCacheSize(sizeMB);
+                std::cout << "Evaluation cache size set to " << sizeMB << " MB" << std::endl;
+            } else {
+                std::cout << "Invalid size!" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cout << "Invalid size!" << std::endl;
+        }
+    } else if (command.substr(0, 8) == "multipv ") {
+        try {
+            int lines = std::stoi(command.substr(8));
+            if (lines > 0) {
+                engine.setMultiPV(lines);
+                std::cout << "Engine will report the best " << lines << " line(s)" << std::endl;
+            } else {
+                std::cout << "Invalid number of lines!" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cout << "Invalid number of lines!" << std::endl;
+        }
+    } else if (command.substr(0, 13) == "historyaging ") {
+        try {
+            int percent = std::stoi(command.substr(13));
+            if (percent >= 0 && percent <= 100) {
+                engine.setHistoryAging(percent);
+                std::cout << "History scores kept between searches: " << percent << "%" << std::endl;
+            } else {
+                std::cout << "Invalid percentage!" << std::endl;
+            }
+        } catch (const std::exception& e) {
+            std::cout << "Invalid percentage!" << std::endl;
+        }
+    } else if (command == "stats") {
+        engine.getSearchStats().print(std::cout);
+    } else if (command == "stats json") {
+        std::cout << engine.getSearchStats().toJSON() << std::endl;
+    } else if (command == "statsfile off") {
+        engine.setStatsFile("");
+        std::cout << "Search statistics file disabled" << std::endl;
+    } else if (command.substr(0, 10) == "statsfile ") {
+        engine.setStatsFile(command.substr(10));
+        std::cout << "Appending search statistics to " << command.substr(10) << std::endl;
+    } else if (command == "bench" || command.substr(0, 6) == "bench ") {
+        int depth = 3;
+        try {
+            if (command.size() > 6) depth = std::stoi(command.substr(6));
+        } catch (const std::exception& e) {
+            depth = 0;
+        }
+        if (depth > 0) {
+            engine.runBench(depth);
+        } else {
+            std::cout << "Invalid depth!" << std::endl;
+        }
     } else if (command == "cleartt") {
         engine.clearTT();
         std::cout << "Transposition table cleared" << std::endl;
+    } else if (command == "book off") {
+        engine.closeBook();
+        std::cout << "Opening book disabled" << std::endl;
+    } else if (command.substr(0, 5) == "book ") {
+        std::string path = command.substr(5);
+        if (engine.loadBook(path)) {
+            std::cout << "Opening book loaded from " << path << std::endl;
+        } else {
+            std::cout << "Could not load opening book " << path << std::endl;
+        }
+    } else if (command.substr(0, 8) == "pruning ") {
+        std::istringstream ss(command.substr(8));
+        std::string technique, state;
+        ss >> technique >> state;
+        if (state != "on" && state != "off") {
+            std::cout << "Usage: pruning <rfp|futility|lmp> <on|off>" << std::endl;
+        } else if (technique == "rfp") {
+            engine.setReverseFutilityPruning(state == "on");
+            std::cout << "Reverse futility pruning " << state << std::endl;
+        } else if (technique == "futility") {
+            engine.setFutilityPruning(state == "on");
+            std::cout << "Futility pruning " << state << std::endl;
+        } else if (technique == "lmp") {
+            engine.setLateMovePruning(state == "on");
+            std::cout << "Late move pruning " << state << std::endl;
+        } else {
+            std::cout << "Usage: pruning <rfp|futility|lmp> <on|off>" << std::endl;
+        }
+    } else if (command == "evalfile off") {
+        engine.useClassicalEval();
+        std::cout << "Using the piece-square evaluation" << std::endl;
+    } else if (command.substr(0, 9) == "evalfile ") {
+        std::string path = command.substr(9);
+        if (engine.loadEvalFile(path)) {
+            std::cout << "Neural network loaded from " << path << std::endl;
+        } else {
+            std::cout << "Could not load neural network " << path << std::endl;
+        }
     } else {
         // Try to interpret the command as a move
         if (isPlayerTurn()) {
@@ -251,6 +348,19 @@ void UI::displayHelp() const {
     std::cout << "  depth [n]      - Set the engine search depth to n" << std::endl;
     std::cout << "  ttsize [n]     - Set the transposition table size to n MB" << std::endl;
     std::cout << "  cleartt        - Clear the transposition table" << std::endl;
+    std::cout << "  evalcache [n]  - Set the evaluation cache size to n MB" << std::endl;
+    std::cout << "  multipv [n]    - Search and report the best n moves, each with its own line" << std::endl;
+    std::cout << "  historyaging [p] - Keep p% of the move history between searches" << std::endl;
+    std::cout << "  stats          - Show the counters of the last search" << std::endl;
+    std::cout << "  stats json     - Print the counters of the last search as JSON" << std::endl;
+    std::cout << "  statsfile [f]  - Append the counters of every search to f as JSON lines" << std::endl;
+    std::cout << "  statsfile off  - Stop writing the statistics file" << std::endl;
+    std::cout << "  bench [n]      - Search the benchmark positions to depth n (default 3)" << std::endl;
+    std::cout << "  book [file]    - Use a Polyglot (.bin) opening book" << std::endl;
+    std::cout << "  book off       - Stop using the opening book" << std::endl;
+    std::cout << "  pruning [t] [on|off] - Toggle rfp, futility or lmp pruning" << std::endl;
+    std::cout << "  evalfile [f]   - Evaluate with the given NNUE network file" << std::endl;
+    std::cout << "  evalfile off   - Go back to the piece-square evaluation" << std::endl;
     std::cout << "  quit/exit      - Exit the program" << std::endl;
     std::cout << std::endl;
     std::cout << "To make a move, enter the source and destination squares." << std::endl;
@@ -19,9 +19,15 @@ private:
     // Random keys for en passant files
     static uint64_t enPassantKeys[8];
     
+    // Random keys for searches that exclude a move [from_square][to_square]
+    static uint64_t excludedMoveKeys[64][64];
+    
     // Has this been initialized?
     static bool initialized;
     
+    // Fixed keys used by Polyglot opening books
+    static const uint64_t polyglotRandom[781];
+    
 public:
     // Initialize all random keys
     static void initialize();
@@ -31,6 +37,19 @@ public:
     
     // Update a hash key when making a move (faster than regenerating)
     static uint64_t updateHashKey(uint64_t currentKey, const Move& move, const Board& board);
+    
+    // Update a hash key for a null move (side to move flips, en passant is cleared)
+    static uint64_t updateHashKeyNullMove(uint64_t currentKey, const Board& board);
+    
+    // Key of a pawn of the given color on a square, for the pawn-only key
+    static uint64_t pawnKey(Color color, const Position& pos);
+    
+    // Key mixed into the position key of a search that excludes the given move,
+    // so its results get their own transposition table entries
+    static uint64_t excludedMoveKey(const Move& move);
+    
+    // Generate the Polyglot-compatible key used to look positions up in .bin books
+    static uint64_t generatePolyglotKey(const Board& board);
 };
 
 #endif // ZOBRIST_H
\ No newline at end of file